@@ -177,6 +177,17 @@ av_cold int ff_frame_thread_encoder_init(AVCodecContext *avctx)
         }
     }
 
+    if (avctx->codec_id == AV_CODEC_ID_FFV1 &&
+        (avctx->gop_size > 1 || (avctx->flags & AV_CODEC_FLAG_PASS1))) {
+        // FFV1 frames are only independent when every frame is a keyframe,
+        // first pass statistics are accumulated over all frames
+        av_log(avctx, AV_LOG_DEBUG,
+               "Not using frame threads for FFV1 encoding with a GOP size "
+               "above 1 or first pass, use -g 1 for frame multi-threading\n");
+        avctx->thread_type = FF_THREAD_SLICE;
+        return 0;
+    }
+
     if(!avctx->thread_count) {
         avctx->thread_count = av_cpu_count();
         avctx->thread_count = FFMIN(avctx->thread_count, MAX_THREADS);
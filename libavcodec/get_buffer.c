@@ -18,6 +18,7 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
 #include <stdint.h>
 
 #include "libavutil/avassert.h"
@@ -50,6 +51,15 @@ typedef struct FramePool {
     int planes;
     int channels;
     int samples;
+
+    /**
+     * Number and total size of the per-plane video buffers allocated by the
+     * pools, i.e. the memory held by the decoder's reference and output
+     * frames. A new FramePool, and thus new counters, is created whenever
+     * the frame parameters change.
+     */
+    atomic_uint nb_buffers;
+    atomic_size_t buffers_size;
 } FramePool;
 
 static void frame_pool_free(void *opaque, uint8_t *data)
@@ -77,10 +87,25 @@ static AVBufferRef *frame_pool_alloc(void)
         av_freep(&pool);
         return NULL;
     }
+    atomic_init(&pool->nb_buffers, 0);
+    atomic_init(&pool->buffers_size, 0);
 
     return buf;
 }
 
+static AVBufferRef *frame_pool_buffer_alloc(void *opaque, size_t size)
+{
+    FramePool *pool = opaque;
+    AVBufferRef *buf = CONFIG_MEMORY_POISONING ? av_buffer_alloc(size) :
+                                                 av_buffer_allocz(size);
+
+    if (buf) {
+        atomic_fetch_add_explicit(&pool->nb_buffers, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->buffers_size, size, memory_order_relaxed);
+    }
+    return buf;
+}
+
 static int update_frame_pool(AVCodecContext *avctx, AVFrame *frame)
 {
     FramePool *pool = avctx->internal->pool ?
@@ -152,10 +177,9 @@ FF_ENABLE_DEPRECATION_WARNINGS
                     ret = AVERROR(EINVAL);
                     goto fail;
                 }
-                pool->pools[i] = av_buffer_pool_init(size[i] + 16 + STRIDE_ALIGN - 1,
-                                                     CONFIG_MEMORY_POISONING ?
-                                                        NULL :
-                                                        av_buffer_allocz);
+                pool->pools[i] = av_buffer_pool_init2(size[i] + 16 + STRIDE_ALIGN - 1,
+                                                      pool, frame_pool_buffer_alloc,
+                                                      NULL);
                 if (!pool->pools[i]) {
                     ret = AVERROR(ENOMEM);
                     goto fail;
@@ -279,7 +303,10 @@ static int video_get_buffer(AVCodecContext *s, AVFrame *pic)
     }
 
     if (s->debug & FF_DEBUG_BUFFERS)
-        av_log(s, AV_LOG_DEBUG, "default_get_buffer called on pic %p\n", pic);
+        av_log(s, AV_LOG_DEBUG, "default_get_buffer called on pic %p, "
+               "frame pool holds %u plane buffers, %zu bytes\n", pic,
+               (unsigned)atomic_load_explicit(&pool->nb_buffers, memory_order_relaxed),
+               (size_t)atomic_load_explicit(&pool->buffers_size, memory_order_relaxed));
 
     return 0;
 fail:
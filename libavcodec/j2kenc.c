@@ -1399,84 +1399,96 @@ static void truncpasses(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile)
     }
 }
 
-static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+/**
+ * DWT and tier-1 coding of one component of one tile.
+ * Jobs only touch their own component, so all of them can run in parallel.
+ */
+static int encode_tile_comp(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
 {
-    int compno, reslevelno, bandno, ret;
+    Jpeg2000EncoderContext *s = avctx->priv_data;
+    int tileno = jobnr / s->ncomponents;
+    int compno = jobnr % s->ncomponents;
+    int reslevelno, bandno, ret;
     Jpeg2000T1Context t1;
     Jpeg2000CodingStyle *codsty = &s->codsty;
-    for (compno = 0; compno < s->ncomponents; compno++){
-        Jpeg2000Component *comp = s->tile[tileno].comp + compno;
-
-        t1.stride = (1<<codsty->log2_cblk_width) + 2;
-
-        av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
-        if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
-            return ret;
-        av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
-
-        for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
-            Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+    Jpeg2000Tile *tile = s->tile + tileno;
+    Jpeg2000Component *comp = tile->comp + compno;
 
-            for (bandno = 0; bandno < reslevel->nbands ; bandno++){
-                Jpeg2000Band *band = reslevel->band + bandno;
-                Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
-                int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
-                yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
-                y0 = yy0;
-                yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
-                            band->coord[1][1]) - band->coord[1][0] + yy0;
+    t1.stride = (1<<codsty->log2_cblk_width) + 2;
 
-                if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
-                    continue;
+    av_log(s->avctx, AV_LOG_DEBUG,"dwt\n");
+    if ((ret = ff_dwt_encode(&comp->dwt, comp->i_data)) < 0)
+        return ret;
+    av_log(s->avctx, AV_LOG_DEBUG,"after dwt -> tier1\n");
 
-                bandpos = bandno + (reslevelno > 0);
-
-                for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
-                    if (reslevelno == 0 || bandno == 1)
-                        xx0 = 0;
-                    else
-                        xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
-                    x0 = xx0;
-                    xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
-                                band->coord[0][1]) - band->coord[0][0] + xx0;
-
-                    for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
-                        int y, x;
-                        if (codsty->transform == FF_DWT53){
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
-                                }
+    for (reslevelno = 0; reslevelno < codsty->nreslevels; reslevelno++){
+        Jpeg2000ResLevel *reslevel = comp->reslevel + reslevelno;
+
+        for (bandno = 0; bandno < reslevel->nbands ; bandno++){
+            Jpeg2000Band *band = reslevel->band + bandno;
+            Jpeg2000Prec *prec = band->prec; // we support only 1 precinct per band ATM in the encoder
+            int cblkx, cblky, cblkno=0, xx0, x0, xx1, y0, yy0, yy1, bandpos;
+            yy0 = bandno == 0 ? 0 : comp->reslevel[reslevelno-1].coord[1][1] - comp->reslevel[reslevelno-1].coord[1][0];
+            y0 = yy0;
+            yy1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[1][0] + 1, band->log2_cblk_height) << band->log2_cblk_height,
+                        band->coord[1][1]) - band->coord[1][0] + yy0;
+
+            if (band->coord[0][0] == band->coord[0][1] || band->coord[1][0] == band->coord[1][1])
+                continue;
+
+            bandpos = bandno + (reslevelno > 0);
+
+            for (cblky = 0; cblky < prec->nb_codeblocks_height; cblky++){
+                if (reslevelno == 0 || bandno == 1)
+                    xx0 = 0;
+                else
+                    xx0 = comp->reslevel[reslevelno-1].coord[0][1] - comp->reslevel[reslevelno-1].coord[0][0];
+                x0 = xx0;
+                xx1 = FFMIN(ff_jpeg2000_ceildivpow2(band->coord[0][0] + 1, band->log2_cblk_width) << band->log2_cblk_width,
+                            band->coord[0][1]) - band->coord[0][0] + xx0;
+
+                for (cblkx = 0; cblkx < prec->nb_codeblocks_width; cblkx++, cblkno++){
+                    int y, x;
+                    if (codsty->transform == FF_DWT53){
+                        for (y = yy0; y < yy1; y++){
+                            int *ptr = t1.data + (y-yy0)*t1.stride;
+                            for (x = xx0; x < xx1; x++){
+                                *ptr++ = comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x] * (1 << NMSEDEC_FRACBITS);
                             }
-                        } else{
-                            for (y = yy0; y < yy1; y++){
-                                int *ptr = t1.data + (y-yy0)*t1.stride;
-                                for (x = xx0; x < xx1; x++){
-                                    *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
-                                    *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
-                                    ptr++;
-                                }
+                        }
+                    } else{
+                        for (y = yy0; y < yy1; y++){
+                            int *ptr = t1.data + (y-yy0)*t1.stride;
+                            for (x = xx0; x < xx1; x++){
+                                *ptr = (comp->i_data[(comp->coord[0][1] - comp->coord[0][0]) * y + x]);
+                                *ptr = (int64_t)*ptr * (int64_t)(16384 * 65536 / band->i_stepsize) >> 15 - NMSEDEC_FRACBITS;
+                                ptr++;
                             }
                         }
-                        if (!prec->cblk[cblkno].data)
-                            prec->cblk[cblkno].data = av_malloc(1 + 8192);
-                        if (!prec->cblk[cblkno].passes)
-                            prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
-                        if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
-                            return AVERROR(ENOMEM);
-                        encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
-                                    bandpos, codsty->nreslevels - reslevelno - 1);
-                        xx0 = xx1;
-                        xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
                     }
-                    yy0 = yy1;
-                    yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
+                    if (!prec->cblk[cblkno].data)
+                        prec->cblk[cblkno].data = av_malloc(1 + 8192);
+                    if (!prec->cblk[cblkno].passes)
+                        prec->cblk[cblkno].passes = av_malloc_array(JPEG2000_MAX_PASSES, sizeof (*prec->cblk[cblkno].passes));
+                    if (!prec->cblk[cblkno].data || !prec->cblk[cblkno].passes)
+                        return AVERROR(ENOMEM);
+                    encode_cblk(s, &t1, prec->cblk + cblkno, tile, xx1 - xx0, yy1 - yy0,
+                                bandpos, codsty->nreslevels - reslevelno - 1);
+                    xx0 = xx1;
+                    xx1 = FFMIN(xx1 + (1 << band->log2_cblk_width), band->coord[0][1] - band->coord[0][0] + x0);
                 }
+                yy0 = yy1;
+                yy1 = FFMIN(yy1 + (1 << band->log2_cblk_height), band->coord[1][1] - band->coord[1][0] + y0);
             }
         }
-        av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
     }
+    av_log(s->avctx, AV_LOG_DEBUG, "after tier1\n");
+    return 0;
+}
+
+static int encode_tile(Jpeg2000EncoderContext *s, Jpeg2000Tile *tile, int tileno)
+{
+    int ret;
 
     av_log(s->avctx, AV_LOG_DEBUG, "rate control\n");
     if (s->compression_rate_enc)
@@ -1528,7 +1540,8 @@ static void update_size(uint8_t *size, const uint8_t *end)
 static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
                         const AVFrame *pict, int *got_packet)
 {
-    int tileno, ret;
+    int tileno, ret, i, nb_jobs;
+    int *job_ret;
     Jpeg2000EncoderContext *s = avctx->priv_data;
     uint8_t *chunkstart, *jp2cstart, *jp2hstart;
 
@@ -1638,6 +1651,22 @@ static int encode_frame(AVCodecContext *avctx, AVPacket *pkt,
     if ((ret = put_com(s, 0)) < 0)
         return ret;
 
+    /* Tier-1 coding runs on all tiles and components at once, rate control
+     * and tier-2 need the shared output buffer and stay serial. */
+    nb_jobs = s->numXtiles * s->numYtiles * s->ncomponents;
+    job_ret = av_malloc_array(nb_jobs, sizeof(*job_ret));
+    if (!job_ret)
+        return AVERROR(ENOMEM);
+    avctx->execute2(avctx, encode_tile_comp, NULL, job_ret, nb_jobs);
+    for (i = 0; i < nb_jobs; i++) {
+        if (job_ret[i] < 0) {
+            ret = job_ret[i];
+            av_free(job_ret);
+            return ret;
+        }
+    }
+    av_free(job_ret);
+
     for (tileno = 0; tileno < s->numXtiles * s->numYtiles; tileno++){
         uint8_t *psotptr;
         if (!(psotptr = put_sot(s, tileno)))
@@ -1835,6 +1864,7 @@ const FFCodec ff_jpeg2000_encoder = {
     .p.long_name    = NULL_IF_CONFIG_SMALL("JPEG 2000"),
     .p.type         = AVMEDIA_TYPE_VIDEO,
     .p.id           = AV_CODEC_ID_JPEG2000,
+    .p.capabilities = AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(Jpeg2000EncoderContext),
     .init           = j2kenc_init,
     FF_CODEC_ENCODE_CB(encode_frame),
@@ -1211,23 +1211,122 @@ static int encode_frame(AVCodecContext *c, AVFrame *frame, AVPacket *pkt)
     return size;
 }
 
-static int estimate_best_b_count(MpegEncContext *s)
+typedef struct BCountCandidate {
+    MpegEncContext *s;
+    int b_count;        ///< number of consecutive B-frames to try
+    int p_lambda, b_lambda, lambda2;
+    int64_t rd;         ///< resulting rate-distortion cost
+} BCountCandidate;
+
+/**
+ * Encode the downscaled look-ahead pictures with one GOP structure.
+ * Candidates are independent of each other, so they are run through
+ * avctx->execute() and evaluated in parallel when slice threads are active.
+ */
+static int estimate_b_count_thread(AVCodecContext *avctx, void *arg)
 {
+    BCountCandidate *cand = arg;
+    MpegEncContext *s = cand->s;
+    const int j = cand->b_count;
+    AVCodecContext *c;
     AVPacket *pkt;
+    AVFrame *frame;
+    int i, out_size, ret;
+    int64_t rd = 0;
+
+    c     = avcodec_alloc_context3(NULL);
+    pkt   = av_packet_alloc();
+    frame = av_frame_alloc();
+    if (!c || !pkt || !frame) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    c->width        = s->width  >> s->brd_scale;
+    c->height       = s->height >> s->brd_scale;
+    c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
+    c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
+    c->mb_decision  = s->avctx->mb_decision;
+    c->me_cmp       = s->avctx->me_cmp;
+    c->mb_cmp       = s->avctx->mb_cmp;
+    c->me_sub_cmp   = s->avctx->me_sub_cmp;
+    c->pix_fmt      = AV_PIX_FMT_YUV420P;
+    c->time_base    = s->avctx->time_base;
+    c->max_b_frames = s->max_b_frames;
+
+    ret = avcodec_open2(c, s->avctx->codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    /* The downscaled pictures are shared between all candidates, so only
+     * the per-candidate picture type and quality go into a new reference. */
+    ret = av_frame_ref(frame, s->tmp_frames[0]);
+    if (ret < 0)
+        goto fail;
+    frame->pict_type = AV_PICTURE_TYPE_I;
+    frame->quality   = 1 * FF_QP2LAMBDA;
+
+    out_size = encode_frame(c, frame, pkt);
+    av_frame_unref(frame);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+
+    //rd += (out_size * cand->lambda2) >> FF_LAMBDA_SHIFT;
+
+    for (i = 0; i < s->max_b_frames + 1; i++) {
+        int is_p = i % (j + 1) == j || i == s->max_b_frames;
+
+        ret = av_frame_ref(frame, s->tmp_frames[i + 1]);
+        if (ret < 0)
+            goto fail;
+        frame->pict_type = is_p ? AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
+        frame->quality   = is_p ? cand->p_lambda : cand->b_lambda;
+
+        out_size = encode_frame(c, frame, pkt);
+        av_frame_unref(frame);
+        if (out_size < 0) {
+            ret = out_size;
+            goto fail;
+        }
+
+        rd += (out_size * cand->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    }
+
+    /* get the delayed frames */
+    out_size = encode_frame(c, NULL, pkt);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+    rd += (out_size * cand->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+
+    rd += c->error[0] + c->error[1] + c->error[2];
+
+    cand->rd = rd;
+    ret      = 0;
+
+fail:
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    avcodec_free_context(&c);
+    return ret;
+}
+
+static int estimate_best_b_count(MpegEncContext *s)
+{
+    BCountCandidate cand[MAX_B_FRAMES + 1];
+    int cand_ret[MAX_B_FRAMES + 1];
     const int scale = s->brd_scale;
     int width  = s->width  >> scale;
     int height = s->height >> scale;
-    int i, j, out_size, p_lambda, b_lambda, lambda2;
+    int i, j, nb_cand, p_lambda, b_lambda, lambda2;
     int64_t best_rd  = INT64_MAX;
     int best_b_count = -1;
-    int ret = 0;
 
     av_assert0(scale >= 0 && scale <= 3);
 
-    pkt = av_packet_alloc();
-    if (!pkt)
-        return AVERROR(ENOMEM);
-
     //emms_c();
     //s->next_picture_ptr->quality;
     p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
@@ -1271,89 +1370,30 @@ static int estimate_best_b_count(MpegEncContext *s)
         }
     }
 
-    for (j = 0; j < s->max_b_frames + 1; j++) {
-        AVCodecContext *c;
-        int64_t rd = 0;
-
-        if (!s->input_picture[j])
+    for (nb_cand = 0; nb_cand < s->max_b_frames + 1; nb_cand++) {
+        if (!s->input_picture[nb_cand])
             break;
 
-        c = avcodec_alloc_context3(NULL);
-        if (!c) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
-        }
-
-        c->width        = width;
-        c->height       = height;
-        c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
-        c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
-        c->mb_decision  = s->avctx->mb_decision;
-        c->me_cmp       = s->avctx->me_cmp;
-        c->mb_cmp       = s->avctx->mb_cmp;
-        c->me_sub_cmp   = s->avctx->me_sub_cmp;
-        c->pix_fmt      = AV_PIX_FMT_YUV420P;
-        c->time_base    = s->avctx->time_base;
-        c->max_b_frames = s->max_b_frames;
-
-        ret = avcodec_open2(c, s->avctx->codec, NULL);
-        if (ret < 0)
-            goto fail;
-
-
-        s->tmp_frames[0]->pict_type = AV_PICTURE_TYPE_I;
-        s->tmp_frames[0]->quality   = 1 * FF_QP2LAMBDA;
-
-        out_size = encode_frame(c, s->tmp_frames[0], pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-
-        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
-
-        for (i = 0; i < s->max_b_frames + 1; i++) {
-            int is_p = i % (j + 1) == j || i == s->max_b_frames;
-
-            s->tmp_frames[i + 1]->pict_type = is_p ?
-                                     AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
-            s->tmp_frames[i + 1]->quality   = is_p ? p_lambda : b_lambda;
-
-            out_size = encode_frame(c, s->tmp_frames[i + 1], pkt);
-            if (out_size < 0) {
-                ret = out_size;
-                goto fail;
-            }
-
-            rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-        }
-
-        /* get the delayed frames */
-        out_size = encode_frame(c, NULL, pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-        rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
+        cand[nb_cand].s        = s;
+        cand[nb_cand].b_count  = nb_cand;
+        cand[nb_cand].p_lambda = p_lambda;
+        cand[nb_cand].b_lambda = b_lambda;
+        cand[nb_cand].lambda2  = lambda2;
+        cand[nb_cand].rd       = INT64_MAX;
+    }
 
-        rd += c->error[0] + c->error[1] + c->error[2];
+    s->avctx->execute(s->avctx, estimate_b_count_thread, cand, cand_ret,
+                      nb_cand, sizeof(*cand));
 
-        if (rd < best_rd) {
-            best_rd = rd;
+    for (j = 0; j < nb_cand; j++) {
+        if (cand_ret[j] < 0)
+            return cand_ret[j];
+        if (cand[j].rd < best_rd) {
+            best_rd = cand[j].rd;
             best_b_count = j;
         }
-
-fail:
-        avcodec_free_context(&c);
-        av_packet_unref(pkt);
-        if (ret < 0) {
-            best_b_count = ret;
-            break;
-        }
     }
 
-    av_packet_free(&pkt);
-
     return best_b_count;
 }
 
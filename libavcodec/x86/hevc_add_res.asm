@@ -24,7 +24,9 @@
 SECTION .text
 
 cextern pw_1023
+cextern pw_4095
 %define max_pixels_10 pw_1023
+%define max_pixels_12 pw_4095
 
 ; the add_res macros and functions were largely inspired by h264_idct.asm from the x264 project
 %macro ADD_RES_MMX_4_8 0
@@ -289,11 +291,12 @@ cglobal hevc_add_residual_32_8, 3, 5, 7
     mova      [%1+%2+32], m3
 %endmacro
 
-; void ff_hevc_add_residual_<4|8|16|32>_10(pixel *dst, int16_t *block, ptrdiff_t stride)
+; void ff_hevc_add_residual_<4|8|16|32>_<10|12>(pixel *dst, int16_t *block, ptrdiff_t stride)
+%macro ADD_RESIDUAL_FUNCS 1
 INIT_MMX mmxext
-cglobal hevc_add_residual_4_10, 3, 3, 6
+cglobal hevc_add_residual_4_%1, 3, 3, 6
     pxor              m2, m2
-    mova              m3, [max_pixels_10]
+    mova              m3, [max_pixels_%1]
     ADD_RES_MMX_4_10  r0, r2, r1
     add               r1, 16
     lea               r0, [r0+2*r2]
@@ -301,9 +304,9 @@ cglobal hevc_add_residual_4_10, 3, 3, 6
     RET
 
 INIT_XMM sse2
-cglobal hevc_add_residual_8_10, 3, 4, 6
+cglobal hevc_add_residual_8_%1, 3, 4, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
     lea               r3, [r2*3]
 
     ADD_RES_SSE_8_10  r0, r2, r3, r1
@@ -312,9 +315,9 @@ cglobal hevc_add_residual_8_10, 3, 4, 6
     ADD_RES_SSE_8_10  r0, r2, r3, r1
     RET
 
-cglobal hevc_add_residual_16_10, 3, 5, 6
+cglobal hevc_add_residual_16_%1, 3, 5, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
 
     mov              r4d, 8
 .loop:
@@ -325,9 +328,9 @@ cglobal hevc_add_residual_16_10, 3, 5, 6
     jg .loop
     RET
 
-cglobal hevc_add_residual_32_10, 3, 5, 6
+cglobal hevc_add_residual_32_%1, 3, 5, 6
     pxor              m4, m4
-    mova              m5, [max_pixels_10]
+    mova              m5, [max_pixels_%1]
 
     mov              r4d, 32
 .loop:
@@ -340,9 +343,9 @@ cglobal hevc_add_residual_32_10, 3, 5, 6
 
 %if HAVE_AVX2_EXTERNAL
 INIT_YMM avx2
-cglobal hevc_add_residual_16_10, 3, 5, 6
+cglobal hevc_add_residual_16_%1, 3, 5, 6
     pxor               m4, m4
-    mova               m5, [max_pixels_10]
+    mova               m5, [max_pixels_%1]
     lea                r3, [r2*3]
 
     mov               r4d, 4
@@ -354,9 +357,9 @@ cglobal hevc_add_residual_16_10, 3, 5, 6
     jg .loop
     RET
 
-cglobal hevc_add_residual_32_10, 3, 5, 6
+cglobal hevc_add_residual_32_%1, 3, 5, 6
     pxor               m4, m4
-    mova               m5, [max_pixels_10]
+    mova               m5, [max_pixels_%1]
 
     mov               r4d, 16
 .loop:
@@ -367,3 +370,7 @@ cglobal hevc_add_residual_32_10, 3, 5, 6
     jg .loop
     RET
 %endif ;HAVE_AVX2_EXTERNAL
+%endmacro
+
+ADD_RESIDUAL_FUNCS 10
+ADD_RESIDUAL_FUNCS 12
@@ -1101,6 +1101,7 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
         }
     } else if (bit_depth == 12) {
         if (EXTERNAL_MMXEXT(cpu_flags)) {
+            c->add_residual[0] = ff_hevc_add_residual_4_12_mmxext;
             c->idct_dc[0] = ff_hevc_idct_4x4_dc_12_mmxext;
         }
         if (EXTERNAL_SSE2(cpu_flags)) {
@@ -1116,6 +1117,10 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
             c->idct_dc[1] = ff_hevc_idct_8x8_dc_12_sse2;
             c->idct_dc[2] = ff_hevc_idct_16x16_dc_12_sse2;
             c->idct_dc[3] = ff_hevc_idct_32x32_dc_12_sse2;
+
+            c->add_residual[1] = ff_hevc_add_residual_8_12_sse2;
+            c->add_residual[2] = ff_hevc_add_residual_16_12_sse2;
+            c->add_residual[3] = ff_hevc_add_residual_32_12_sse2;
         }
         if (EXTERNAL_SSSE3(cpu_flags) && ARCH_X86_64) {
             c->hevc_v_loop_filter_luma = ff_hevc_v_loop_filter_luma_12_ssse3;
@@ -1150,6 +1155,9 @@ void ff_hevc_dsp_init_x86(HEVCDSPContext *c, const int bit_depth)
 
             SAO_BAND_INIT(12, avx2);
             SAO_EDGE_INIT(12, avx2);
+
+            c->add_residual[2] = ff_hevc_add_residual_16_12_avx2;
+            c->add_residual[3] = ff_hevc_add_residual_32_12_avx2;
         }
     }
 }
@@ -22,15 +22,22 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/intreadwrite.h"
+#include "libavutil/opt.h"
 #include "avformat.h"
 #include "avio_internal.h"
 #include "internal.h"
 #include "id3v1.h"
 #include "id3v2.h"
 #include "apetag.h"
+#include "seekindex.h"
 
 #define ADTS_HEADER_SIZE 7
 
+typedef struct AACDemuxContext {
+    const AVClass *class;
+    char *seek_index;
+} AACDemuxContext;
+
 static int adts_aac_probe(const AVProbeData *p)
 {
     int max_frames = 0, first_frames = 0;
@@ -105,6 +112,7 @@ static int adts_aac_resync(AVFormatContext *s)
 
 static int adts_aac_read_header(AVFormatContext *s)
 {
+    AACDemuxContext *aac = s->priv_data;
     AVStream *st;
     int ret;
 
@@ -131,6 +139,13 @@ static int adts_aac_read_header(AVFormatContext *s)
     // LCM of all possible ADTS sample rates
     avpriv_set_pts_info(st, 64, 1, 28224000);
 
+    if (aac->seek_index) {
+        int64_t cur = avio_tell(s->pb);
+        if (ff_seek_index_read(s, aac->seek_index) < 0)
+            av_log(s, AV_LOG_WARNING, "Falling back to seeking without the seek index\n");
+        avio_seek(s->pb, cur, SEEK_SET);
+    }
+
     return 0;
 }
 
@@ -208,9 +223,24 @@ retry:
     return ret;
 }
 
+static const AVOption aac_options[] = {
+    { "seek_index", "read the seek index from the given file", offsetof(AACDemuxContext, seek_index),
+      AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, AV_OPT_FLAG_DECODING_PARAM },
+    { NULL },
+};
+
+static const AVClass aac_demuxer_class = {
+    .class_name = "aac demuxer",
+    .item_name  = av_default_item_name,
+    .option     = aac_options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
 const AVInputFormat ff_aac_demuxer = {
     .name         = "aac",
     .long_name    = NULL_IF_CONFIG_SMALL("raw ADTS AAC (Advanced Audio Coding)"),
+    .priv_data_size = sizeof(AACDemuxContext),
+    .priv_class   = &aac_demuxer_class,
     .read_probe   = adts_aac_probe,
     .read_header  = adts_aac_read_header,
     .read_packet  = adts_aac_read_packet,
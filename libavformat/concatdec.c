@@ -24,6 +24,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
 #include "libavutil/timestamp.h"
 #include "libavcodec/bsf.h"
 #include "avformat.h"
@@ -70,6 +71,17 @@ typedef struct {
     ConcatMatchMode stream_match_mode;
     unsigned auto_convert;
     int segment_time_metadata;
+    int preopen;
+    int homogeneous;
+    AVCodecParameters **ref_par;
+    int nb_ref_par;
+#if HAVE_THREADS
+    pthread_t preopen_thread;
+    int preopen_running;
+    unsigned preopen_fileno;
+    AVFormatContext *preopen_avf;
+    int preopen_ret;
+#endif
 } ConcatContext;
 
 static int concat_probe(const AVProbeData *probe)
@@ -330,42 +342,209 @@ static int64_t get_best_effort_duration(ConcatFile *file, AVFormatContext *avf)
     return AV_NOPTS_VALUE;
 }
 
-static int open_file(AVFormatContext *avf, unsigned fileno)
+static void update_timings_from_streams(AVFormatContext *ctx)
+{
+    int64_t start_time = INT64_MAX, end_time = INT64_MIN;
+
+    for (unsigned i = 0; i < ctx->nb_streams; i++) {
+        const AVStream *st = ctx->streams[i];
+        int64_t start;
+
+        if (st->start_time == AV_NOPTS_VALUE)
+            continue;
+        start = av_rescale_q(st->start_time, st->time_base, AV_TIME_BASE_Q);
+        start_time = FFMIN(start_time, start);
+        if (st->duration != AV_NOPTS_VALUE)
+            end_time = FFMAX(end_time, start +
+                             av_rescale_q(st->duration, st->time_base, AV_TIME_BASE_Q));
+    }
+    if (ctx->start_time == AV_NOPTS_VALUE && start_time != INT64_MAX)
+        ctx->start_time = start_time;
+    if (ctx->duration == AV_NOPTS_VALUE && end_time > start_time &&
+        start_time != INT64_MAX)
+        ctx->duration = end_time - start_time;
+}
+
+/**
+ * Copy the codec parameters of the first file to the streams of ctx if
+ * they match its stream layout.
+ * @return 1 if the parameters were copied, 0 if the layout does not match,
+ *         a negative error code on failure
+ */
+static int copy_ref_params(ConcatContext *cat, AVFormatContext *ctx)
 {
-    ConcatContext *cat = avf->priv_data;
-    ConcatFile *file = &cat->files[fileno];
-    AVDictionary *options = NULL;
     int ret;
 
-    if (cat->avf)
-        avformat_close_input(&cat->avf);
+    if (ctx->nb_streams != cat->nb_ref_par)
+        return 0;
+    for (unsigned i = 0; i < ctx->nb_streams; i++) {
+        const AVCodecParameters *par = ctx->streams[i]->codecpar;
+        if (par->codec_type != cat->ref_par[i]->codec_type ||
+            par->codec_id   != cat->ref_par[i]->codec_id   ||
+            par->codec_id   == AV_CODEC_ID_NONE)
+            return 0;
+    }
+    for (unsigned i = 0; i < ctx->nb_streams; i++)
+        if ((ret = avcodec_parameters_copy(ctx->streams[i]->codecpar, cat->ref_par[i])) < 0)
+            return ret;
+    return 1;
+}
 
-    cat->avf = avformat_alloc_context();
-    if (!cat->avf)
+static int save_ref_params(ConcatContext *cat)
+{
+    cat->ref_par = av_calloc(cat->avf->nb_streams, sizeof(*cat->ref_par));
+    if (!cat->ref_par)
         return AVERROR(ENOMEM);
+    for (unsigned i = 0; i < cat->avf->nb_streams; i++) {
+        cat->ref_par[i] = avcodec_parameters_alloc();
+        if (!cat->ref_par[i])
+            return AVERROR(ENOMEM);
+        cat->nb_ref_par++;
+        if (avcodec_parameters_copy(cat->ref_par[i], cat->avf->streams[i]->codecpar) < 0)
+            return AVERROR(ENOMEM);
+    }
+    return 0;
+}
+
+/**
+ * Open and probe the input of a file.
+ * This may run on the pre-open thread and must not modify the state of
+ * the concat demuxer.
+ */
+static int open_input(AVFormatContext *avf, ConcatFile *file,
+                      AVFormatContext **rctx)
+{
+    ConcatContext *cat = avf->priv_data;
+    AVFormatContext *ctx;
+    AVDictionary *options = NULL;
+    int ret;
 
-    cat->avf->flags |= avf->flags & ~AVFMT_FLAG_CUSTOM_IO;
-    cat->avf->interrupt_callback = avf->interrupt_callback;
+    ctx = avformat_alloc_context();
+    if (!ctx)
+        return AVERROR(ENOMEM);
 
-    if ((ret = ff_copy_whiteblacklists(cat->avf, avf)) < 0)
-        return ret;
+    ctx->flags |= avf->flags & ~AVFMT_FLAG_CUSTOM_IO;
+    ctx->interrupt_callback = avf->interrupt_callback;
 
-    ret = av_dict_copy(&options, file->options, 0);
-    if (ret < 0)
+    if ((ret = ff_copy_whiteblacklists(ctx, avf)) < 0 ||
+        (ret = av_dict_copy(&options, file->options, 0)) < 0) {
+        avformat_free_context(ctx);
         return ret;
+    }
 
-    if ((ret = avformat_open_input(&cat->avf, file->url, NULL, &options)) < 0 ||
-        (ret = avformat_find_stream_info(cat->avf, NULL)) < 0) {
-        av_log(avf, AV_LOG_ERROR, "Impossible to open '%s'\n", file->url);
-        av_dict_free(&options);
-        avformat_close_input(&cat->avf);
-        return ret;
+    if ((ret = avformat_open_input(&ctx, file->url, NULL, &options)) < 0)
+        goto fail;
+    /* With homogeneous inputs, only the first file needs to be probed,
+     * as long as the header of the others provides their start time. */
+    if (cat->homogeneous && cat->ref_par) {
+        if ((ret = copy_ref_params(cat, ctx)) < 0)
+            goto fail;
+        if (ret)
+            update_timings_from_streams(ctx);
     }
+    if (!ret || ctx->start_time == AV_NOPTS_VALUE)
+        if ((ret = avformat_find_stream_info(ctx, NULL)) < 0)
+            goto fail;
     if (options) {
         av_log(avf, AV_LOG_WARNING, "Unused options for '%s'.\n", file->url);
         /* TODO log unused options once we have a proper string API */
         av_dict_free(&options);
     }
+    *rctx = ctx;
+    return 0;
+
+fail:
+    av_log(avf, AV_LOG_ERROR, "Impossible to open '%s'\n", file->url);
+    av_dict_free(&options);
+    avformat_close_input(&ctx);
+    return ret;
+}
+
+#if HAVE_THREADS
+static void *preopen_thread(void *arg)
+{
+    AVFormatContext *avf = arg;
+    ConcatContext *cat = avf->priv_data;
+
+    cat->preopen_ret = open_input(avf, &cat->files[cat->preopen_fileno],
+                                  &cat->preopen_avf);
+    return NULL;
+}
+#endif
+
+static void preopen_start(AVFormatContext *avf, unsigned fileno)
+{
+#if HAVE_THREADS
+    ConcatContext *cat = avf->priv_data;
+    int ret;
+
+    if (!cat->preopen || cat->preopen_running || fileno >= cat->nb_files)
+        return;
+    cat->preopen_fileno = fileno;
+    cat->preopen_avf    = NULL;
+    ret = pthread_create(&cat->preopen_thread, NULL, preopen_thread, avf);
+    if (ret) {
+        av_log(avf, AV_LOG_WARNING, "Failed to create the pre-open thread: %s\n",
+               av_err2str(AVERROR(ret)));
+        return;
+    }
+    cat->preopen_running = 1;
+#endif
+}
+
+/**
+ * Wait for the pre-open thread. If it was opening fileno, return its
+ * context in rctx and 1, or its error code and no context if opening failed.
+ * Any other pre-opened context is closed and 0 is returned.
+ */
+static int preopen_finish(AVFormatContext *avf, unsigned fileno,
+                          AVFormatContext **rctx)
+{
+#if HAVE_THREADS
+    ConcatContext *cat = avf->priv_data;
+
+    *rctx = NULL;
+    if (!cat->preopen_running)
+        return 0;
+    pthread_join(cat->preopen_thread, NULL);
+    cat->preopen_running = 0;
+    if (cat->preopen_fileno == fileno) {
+        *rctx = cat->preopen_avf;
+        cat->preopen_avf = NULL;
+        return cat->preopen_ret < 0 ? cat->preopen_ret : 1;
+    }
+    avformat_close_input(&cat->preopen_avf);
+#else
+    *rctx = NULL;
+#endif
+    return 0;
+}
+
+static int open_file(AVFormatContext *avf, unsigned fileno)
+{
+    ConcatContext *cat = avf->priv_data;
+    ConcatFile *file = &cat->files[fileno];
+    AVFormatContext *preopened;
+    int ret;
+
+    ret = preopen_finish(avf, fileno, &preopened);
+
+    if (cat->avf)
+        avformat_close_input(&cat->avf);
+
+    /* The failure of a pre-open may be transient or caused by running
+     * concurrently with the current file, so open the file again here. */
+    if (ret < 0)
+        av_log(avf, AV_LOG_WARNING, "Pre-opening '%s' failed, retrying\n",
+               file->url);
+    if (preopened) {
+        cat->avf = preopened;
+    } else if ((ret = open_input(avf, file, &cat->avf)) < 0) {
+        return ret;
+    }
+    if (cat->homogeneous && !cat->ref_par &&
+        (ret = save_ref_params(cat)) < 0)
+        return ret;
     cat->cur_file = file;
     file->start_time = !fileno ? 0 :
                        cat->files[fileno - 1].start_time +
@@ -386,14 +565,20 @@ static int open_file(AVFormatContext *avf, unsigned fileno)
        if ((ret = avformat_seek_file(cat->avf, -1, INT64_MIN, file->inpoint, file->inpoint, 0)) < 0)
            return ret;
     }
+    preopen_start(avf, fileno + 1);
     return 0;
 }
 
 static int concat_read_close(AVFormatContext *avf)
 {
     ConcatContext *cat = avf->priv_data;
+    AVFormatContext *preopened;
     unsigned i, j;
 
+    preopen_finish(avf, UINT_MAX, &preopened);
+    for (i = 0; i < cat->nb_ref_par; i++)
+        avcodec_parameters_free(&cat->ref_par[i]);
+    av_freep(&cat->ref_par);
     for (i = 0; i < cat->nb_files; i++) {
         av_freep(&cat->files[i].url);
         for (j = 0; j < cat->files[i].nb_streams; j++) {
@@ -922,6 +1107,10 @@ static const AVOption options[] = {
       OFFSET(auto_convert), AV_OPT_TYPE_BOOL, {.i64 = 1}, 0, 1, DEC },
     { "segment_time_metadata", "output file segment start time and duration as packet metadata",
       OFFSET(segment_time_metadata), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, DEC },
+    { "preopen", "open and probe the next file in the background",
+      OFFSET(preopen), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, DEC },
+    { "homogeneous", "assume all files have the streams and codec parameters of the first one",
+      OFFSET(homogeneous), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, DEC },
     { NULL }
 };
 
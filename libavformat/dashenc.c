@@ -127,7 +127,9 @@ typedef struct OutputStream {
     const char *media_seg_name;
 
     char codec_str[100];
-    int written_len;
+    int written_len;        /* bytes of the current segment already forwarded to out */
+    int nb_chunks;
+    int64_t chunk_write_time, max_chunk_write_time;
     char filename[1024];
     char full_path[1024];
     char temp_path[1024];
@@ -458,10 +460,11 @@ static int flush_dynbuf(DASHContext *c, OutputStream *os, int *range_length)
 
     if (!c->single_file) {
         // write out to file
-        *range_length = avio_close_dyn_buf(os->ctx->pb, &buffer);
+        int size = avio_close_dyn_buf(os->ctx->pb, &buffer);
         os->ctx->pb = NULL;
         if (os->out)
-            avio_write(os->out, buffer + os->written_len, *range_length - os->written_len);
+            avio_write(os->out, buffer, size);
+        *range_length = os->written_len + size;
         os->written_len = 0;
         av_free(buffer);
 
@@ -2264,6 +2267,10 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
         if (ret < 0) {
             return handle_io_open_error(s, ret, os->temp_path);
         }
+        // chunks are flushed one by one anyway, write them without
+        // copying them into the output buffer first
+        if (c->streaming && os->segment_type == SEGMENT_TYPE_MP4)
+            os->out->direct = 1;
 
         // in streaming mode, the segments are available for playing
         // before fully written but the manifest is needed so that
@@ -2279,16 +2286,28 @@ static int dash_write_packet(AVFormatContext *s, AVPacket *pkt)
     }
 
     //write out the data immediately in streaming mode
-    if (c->streaming && os->segment_type == SEGMENT_TYPE_MP4) {
+    if (c->streaming && os->segment_type == SEGMENT_TYPE_MP4 && !c->single_file) {
         int len = 0;
         uint8_t *buf = NULL;
         avio_flush(os->ctx->pb);
         len = avio_get_dyn_buf (os->ctx->pb, &buf);
-        if (os->out) {
-            avio_write(os->out, buf + os->written_len, len - os->written_len);
-            avio_flush(os->out);
+        if (len > 0) {
+            int64_t start = av_gettime_relative(), elapsed;
+            if (os->out) {
+                avio_write(os->out, buf, len);
+                avio_flush(os->out);
+            }
+            elapsed = av_gettime_relative() - start;
+            av_log(s, AV_LOG_DEBUG, "Representation %d chunk of %d bytes written in %"PRId64" us\n",
+                   pkt->stream_index, len, elapsed);
+            os->nb_chunks++;
+            os->chunk_write_time    += elapsed;
+            os->max_chunk_write_time = FFMAX(os->max_chunk_write_time, elapsed);
+            // the data is not needed anymore, so the buffer does not have
+            // to hold the whole segment
+            os->written_len += len;
+            ffio_reset_dyn_buf(os->ctx->pb);
         }
-        os->written_len = len;
     }
 
     return ret;
@@ -2313,6 +2332,15 @@ static int dash_write_trailer(AVFormatContext *s)
     }
     dash_flush(s, 1, -1);
 
+    for (i = 0; i < s->nb_streams; i++) {
+        OutputStream *os = &c->streams[i];
+        if (os->nb_chunks)
+            av_log(s, AV_LOG_VERBOSE, "Representation %d: %d chunks written, "
+                   "write time mean %"PRId64" us, max %"PRId64" us\n",
+                   i, os->nb_chunks, os->chunk_write_time / os->nb_chunks,
+                   os->max_chunk_write_time);
+    }
+
     if (c->remove_at_exit) {
         for (i = 0; i < s->nb_streams; ++i) {
             OutputStream *os = &c->streams[i];
@@ -1981,6 +1981,23 @@ static int has_codec_parameters(const AVStream *st, const char **errmsg_ptr)
     return 1;
 }
 
+/**
+ * Set the threading options of a decoder opened for probing a stream.
+ */
+static void set_probe_thread_opts(const AVStream *st, AVDictionary **opts)
+{
+    /* Force thread count to 1 since the H.264 decoder will not extract
+     * SPS and PPS to extradata during multi-threaded decoding.
+     * Other decoders keep the thread count of the caller, which defaults
+     * to 1, but only use slice threads, as frame threads would delay the
+     * output and require reading more packets before the parameters are
+     * known. */
+    if (st->codecpar->codec_id == AV_CODEC_ID_H264)
+        av_dict_set(opts, "threads", "1", 0);
+    else
+        av_dict_set(opts, "thread_type", "slice", 0);
+}
+
 /* returns 1 or 0 if or if not decoded data was returned, or a negative error */
 static int try_decode_frame(AVFormatContext *s, AVStream *st,
                             const AVPacket *avpkt, AVDictionary **options)
@@ -2011,9 +2028,7 @@ static int try_decode_frame(AVFormatContext *s, AVStream *st,
             goto fail;
         }
 
-        /* Force thread count to 1 since the H.264 decoder will not extract
-         * SPS and PPS to extradata during multi-threaded decoding. */
-        av_dict_set(options ? options : &thread_opt, "threads", "1", 0);
+        set_probe_thread_opts(st, options ? options : &thread_opt);
         /* Force lowres to 0. The decoder might reduce the video size by the
          * lowres factor, and we don't want that propagated to the stream's
          * codecpar */
@@ -2491,9 +2506,7 @@ int avformat_find_stream_info(AVFormatContext *ic, AVDictionary **options)
 
         codec = find_probe_decoder(ic, st, st->codecpar->codec_id);
 
-        /* Force thread count to 1 since the H.264 decoder will not extract
-         * SPS and PPS to extradata during multi-threaded decoding. */
-        av_dict_set(options ? &options[i] : &thread_opt, "threads", "1", 0);
+        set_probe_thread_opts(st, options ? &options[i] : &thread_opt);
         /* Force lowres to 0. The decoder might reduce the video size by the
          * lowres factor, and we don't want that propagated to the stream's
          * codecpar */
@@ -83,6 +83,14 @@ typedef struct FifoContext {
     atomic_int_least64_t queue_duration;
     int64_t last_sent_dts;
     int64_t timeshift;
+
+    /* Queue statistics, only accessed by the main thread */
+    int64_t nb_queued_pkts;
+    int64_t nb_dropped_pkts;
+    int max_queue_depth;
+    /* Packets discarded by the consumer thread when flushing the queue,
+     * waiting for a keyframe or recovering, read after joining it */
+    int64_t nb_discarded_pkts;
 } FifoContext;
 
 typedef struct FifoThreadContext {
@@ -196,6 +204,7 @@ static int fifo_thread_write_packet(FifoThreadContext *ctx, AVPacket *pkt)
         } else {
             av_log(avf, AV_LOG_VERBOSE, "Dropping non-keyframe packet\n");
             av_packet_unref(pkt);
+            fifo->nb_discarded_pkts++;
             return 0;
         }
     }
@@ -411,8 +420,10 @@ static int fifo_thread_recover(FifoThreadContext *ctx, FifoMessage *msg, int err
     } while (ret == AVERROR(EAGAIN) && !fifo->drop_pkts_on_overflow);
 
     if (ret == AVERROR(EAGAIN) && fifo->drop_pkts_on_overflow) {
-        if (msg->type == FIFO_WRITE_PACKET)
+        if (msg->type == FIFO_WRITE_PACKET) {
             av_packet_unref(&msg->pkt);
+            fifo->nb_discarded_pkts++;
+        }
         ret = 0;
     }
 
@@ -453,6 +464,8 @@ static void *fifo_consumer_thread(void *data)
          * set, the queue is flushed and flag cleared. */
         pthread_mutex_lock(&fifo->overflow_flag_lock);
         if (fifo->overflow_flag) {
+            /* The queue is full, so nothing is added until it is flushed. */
+            fifo->nb_discarded_pkts += av_thread_message_queue_nb_elems(queue);
             av_thread_message_flush(queue);
             if (fifo->restart_with_keyframe)
                 fifo_thread_ctx.drop_until_keyframe = 1;
@@ -599,12 +612,19 @@ static int fifo_write_packet(AVFormatContext *avf, AVPacket *pkt)
 
         if (overflow_set)
             av_log(avf, AV_LOG_WARNING, "FIFO queue full\n");
+        fifo->nb_dropped_pkts += !!pkt;
         ret = 0;
         goto fail;
     } else if (ret < 0) {
         goto fail;
     }
 
+    if (pkt) {
+        fifo->nb_queued_pkts++;
+        fifo->max_queue_depth = FFMAX(fifo->max_queue_depth,
+                                      av_thread_message_queue_nb_elems(fifo->queue));
+    }
+
     if (fifo->timeshift && pkt && pkt->dts != AV_NOPTS_VALUE)
         atomic_fetch_add_explicit(&fifo->queue_duration, next_duration(avf, pkt, &fifo->last_sent_dts), memory_order_relaxed);
 
@@ -650,6 +670,13 @@ static int fifo_write_trailer(AVFormatContext *avf)
         return AVERROR(ret);
     }
 
+    av_log(avf, AV_LOG_VERBOSE, "%"PRId64" packets queued, %"PRId64" dropped "
+           "(%"PRId64" rejected by the full queue, %"PRId64" discarded from it), "
+           "maximum queue depth %d/%d\n", fifo->nb_queued_pkts,
+           fifo->nb_dropped_pkts + fifo->nb_discarded_pkts,
+           fifo->nb_dropped_pkts, fifo->nb_discarded_pkts,
+           fifo->max_queue_depth, fifo->queue_size);
+
     ret = fifo->write_trailer_ret;
     return ret;
 }
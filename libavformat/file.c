@@ -22,8 +22,11 @@
 #include "config_components.h"
 
 #include "libavutil/avstring.h"
+#include "libavutil/fifo.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
 #include "avformat.h"
 #if HAVE_DIRENT_H
 #include <dirent.h>
@@ -67,6 +70,11 @@
 #  endif
 #endif
 
+/* Maximum size of a single write() of the write-behind thread */
+#define WRITE_BEHIND_CHUNK (1 << 20)
+/* Amount of written data after which drop_cache evicts it from the cache */
+#define DROP_CACHE_INTERVAL (16 << 20)
+
 /* standard file protocol */
 
 typedef struct FileContext {
@@ -79,6 +87,26 @@ typedef struct FileContext {
 #if HAVE_DIRENT_H
     DIR *dir;
 #endif
+
+    int64_t preallocate;
+    int64_t pos;            ///< current position, tracked with preallocate
+    int64_t end;            ///< end of the written data, tracked with preallocate
+
+    int write_behind;
+    int drop_cache;
+    int64_t stall_count;
+    int64_t stall_time;
+#if HAVE_THREADS
+    AVFifo *wb_fifo;
+    uint8_t *wb_buf;
+    int wb_error;
+    int wb_abort;
+    int64_t cache_start, cache_end;
+    pthread_mutex_t wb_mutex;
+    pthread_cond_t wb_cond_main;
+    pthread_cond_t wb_cond_background;
+    pthread_t wb_thread;
+#endif
 } FileContext;
 
 static const AVOption file_options[] = {
@@ -86,6 +114,11 @@ static const AVOption file_options[] = {
     { "blocksize", "set I/O operation maximum block size", offsetof(FileContext, blocksize), AV_OPT_TYPE_INT, { .i64 = INT_MAX }, 1, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
     { "follow", "Follow a file as it is being written", offsetof(FileContext, follow), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_DECODING_PARAM },
     { "seekable", "Sets if the file is seekable", offsetof(FileContext, seekable), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, 0, AV_OPT_FLAG_DECODING_PARAM | AV_OPT_FLAG_ENCODING_PARAM },
+    { "preallocate", "preallocate this many bytes of disk space on write", offsetof(FileContext, preallocate), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, AV_OPT_FLAG_ENCODING_PARAM },
+    { "write_behind", "size of the buffer of data written from a separate thread", offsetof(FileContext, write_behind), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM },
+    { "drop_cache", "evict written data from the page cache", offsetof(FileContext, drop_cache), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, AV_OPT_FLAG_ENCODING_PARAM },
+    { "stall_count", "export the number of writes which waited for the write-behind buffer", offsetof(FileContext, stall_count), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "stall_time", "export the time spent waiting for the write-behind buffer (in microseconds)", offsetof(FileContext, stall_time), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
     { NULL }
 };
 
@@ -121,13 +154,215 @@ static int file_read(URLContext *h, unsigned char *buf, int size)
     return (ret == -1) ? AVERROR(errno) : ret;
 }
 
+#if HAVE_THREADS
+static void drop_cache(FileContext *c)
+{
+#if HAVE_POSIX_FADVISE
+    /* Dirty pages cannot be dropped, write them out first. */
+    fdatasync(c->fd);
+    posix_fadvise(c->fd, c->cache_start, c->cache_end - c->cache_start,
+                  POSIX_FADV_DONTNEED);
+#endif
+    c->cache_start = c->cache_end = 0;
+}
+
+static void *write_behind_task(void *arg)
+{
+    URLContext *h = arg;
+    FileContext *c = h->priv_data;
+
+    pthread_mutex_lock(&c->wb_mutex);
+    while (1) {
+        size_t size = FFMIN(av_fifo_can_read(c->wb_fifo), WRITE_BEHIND_CHUNK);
+        int64_t pos = 0;
+        int ret = 0;
+
+        if (!size) {
+            if (c->wb_abort)
+                break;
+            pthread_cond_wait(&c->wb_cond_background, &c->wb_mutex);
+            continue;
+        }
+
+        /* The fifo is only drained once the data is written, so that the
+         * main thread can wait for an empty fifo before seeking. */
+        av_fifo_peek(c->wb_fifo, c->wb_buf, size, 0);
+        pthread_mutex_unlock(&c->wb_mutex);
+
+        if (c->drop_cache)
+            pos = lseek(c->fd, 0, SEEK_CUR);
+        for (size_t done = 0; done < size; done += ret) {
+            ret = write(c->fd, c->wb_buf + done, size - done);
+            if (ret < 0 && errno == EINTR) {
+                ret = 0;
+            } else if (ret <= 0) {
+                /* Save errno before the calls below can change it. A write
+                 * of nothing would be retried forever. */
+                ret = ret < 0 ? AVERROR(errno) : AVERROR(EIO);
+                break;
+            }
+        }
+        if (c->drop_cache && pos >= 0) {
+            if (c->cache_start == c->cache_end)
+                c->cache_start = c->cache_end = pos;
+            c->cache_start = FFMIN(c->cache_start, pos);
+            c->cache_end   = FFMAX(c->cache_end, pos + (int64_t)size);
+            if (c->cache_end - c->cache_start >= DROP_CACHE_INTERVAL)
+                drop_cache(c);
+        }
+
+        pthread_mutex_lock(&c->wb_mutex);
+        if (ret < 0) {
+            c->wb_error = ret;
+            av_fifo_reset2(c->wb_fifo);
+        } else {
+            av_fifo_drain2(c->wb_fifo, size);
+        }
+        pthread_cond_signal(&c->wb_cond_main);
+    }
+    pthread_mutex_unlock(&c->wb_mutex);
+
+    if (c->drop_cache && c->cache_start != c->cache_end)
+        drop_cache(c);
+
+    return NULL;
+}
+
+static int write_behind_write(URLContext *h, const unsigned char *buf, int size)
+{
+    FileContext *c = h->priv_data;
+    int ret;
+
+    pthread_mutex_lock(&c->wb_mutex);
+    if (!c->wb_error && !av_fifo_can_write(c->wb_fifo)) {
+        int64_t start = av_gettime_relative();
+        c->stall_count++;
+        while (!c->wb_error && !av_fifo_can_write(c->wb_fifo))
+            pthread_cond_wait(&c->wb_cond_main, &c->wb_mutex);
+        c->stall_time += av_gettime_relative() - start;
+    }
+    ret = c->wb_error;
+    if (!ret) {
+        ret = FFMIN(size, av_fifo_can_write(c->wb_fifo));
+        av_fifo_write(c->wb_fifo, buf, ret);
+        pthread_cond_signal(&c->wb_cond_background);
+    }
+    pthread_mutex_unlock(&c->wb_mutex);
+
+    return ret;
+}
+
+/* Wait until all the buffered data has been written. */
+static int write_behind_flush(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    int ret;
+
+    pthread_mutex_lock(&c->wb_mutex);
+    while (!c->wb_error && av_fifo_can_read(c->wb_fifo))
+        pthread_cond_wait(&c->wb_cond_main, &c->wb_mutex);
+    ret = c->wb_error;
+    pthread_mutex_unlock(&c->wb_mutex);
+
+    return ret;
+}
+
+static int write_behind_open(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    int ret;
+
+    c->wb_fifo = av_fifo_alloc2(c->write_behind, 1, 0);
+    c->wb_buf  = av_malloc(FFMIN(c->write_behind, WRITE_BEHIND_CHUNK));
+    if (!c->wb_fifo || !c->wb_buf) {
+        ret = AVERROR(ENOMEM);
+        goto fifo_fail;
+    }
+
+    ret = pthread_mutex_init(&c->wb_mutex, NULL);
+    if (ret) {
+        ret = AVERROR(ret);
+        goto fifo_fail;
+    }
+    ret = pthread_cond_init(&c->wb_cond_main, NULL);
+    if (ret) {
+        ret = AVERROR(ret);
+        goto cond_main_fail;
+    }
+    ret = pthread_cond_init(&c->wb_cond_background, NULL);
+    if (ret) {
+        ret = AVERROR(ret);
+        goto cond_background_fail;
+    }
+    ret = pthread_create(&c->wb_thread, NULL, write_behind_task, h);
+    if (ret) {
+        av_log(h, AV_LOG_ERROR, "pthread_create failed: %s\n", av_err2str(AVERROR(ret)));
+        ret = AVERROR(ret);
+        goto thread_fail;
+    }
+
+    return 0;
+
+thread_fail:
+    pthread_cond_destroy(&c->wb_cond_background);
+cond_background_fail:
+    pthread_cond_destroy(&c->wb_cond_main);
+cond_main_fail:
+    pthread_mutex_destroy(&c->wb_mutex);
+fifo_fail:
+    av_fifo_freep2(&c->wb_fifo);
+    av_freep(&c->wb_buf);
+    return ret;
+}
+
+static int write_behind_close(URLContext *h)
+{
+    FileContext *c = h->priv_data;
+    int ret;
+
+    pthread_mutex_lock(&c->wb_mutex);
+    c->wb_abort = 1;
+    pthread_cond_signal(&c->wb_cond_background);
+    pthread_mutex_unlock(&c->wb_mutex);
+
+    pthread_join(c->wb_thread, NULL);
+    ret = c->wb_error;
+
+    pthread_cond_destroy(&c->wb_cond_background);
+    pthread_cond_destroy(&c->wb_cond_main);
+    pthread_mutex_destroy(&c->wb_mutex);
+    av_fifo_freep2(&c->wb_fifo);
+    av_freep(&c->wb_buf);
+
+    av_log(h, AV_LOG_VERBOSE, "%"PRId64" writes stalled for %"PRId64" ms in total\n",
+           c->stall_count, c->stall_time / 1000);
+
+    return ret;
+}
+#endif /* HAVE_THREADS */
+
 static int file_write(URLContext *h, const unsigned char *buf, int size)
 {
     FileContext *c = h->priv_data;
     int ret;
     size = FFMIN(size, c->blocksize);
-    ret = write(c->fd, buf, size);
-    return (ret == -1) ? AVERROR(errno) : ret;
+#if HAVE_THREADS
+    if (c->wb_fifo) {
+        ret = write_behind_write(h, buf, size);
+        if (ret < 0)
+            return ret;
+    } else
+#endif
+    {
+        ret = write(c->fd, buf, size);
+        if (ret == -1)
+            return AVERROR(errno);
+    }
+    if (ret > 0 && c->preallocate) {
+        c->pos += ret;
+        c->end  = FFMAX(c->end, c->pos);
+    }
+    return ret;
 }
 
 static int file_get_handle(URLContext *h)
@@ -241,6 +476,35 @@ static int file_open(URLContext *h, const char *filename, int flags)
     if (c->seekable >= 0)
         h->is_streamed = !c->seekable;
 
+#if HAVE_POSIX_FALLOCATE
+    if (c->preallocate && flags & AVIO_FLAG_WRITE &&
+        !fstat(fd, &st) && S_ISREG(st.st_mode)) {
+        c->end = st.st_size;
+        if (c->preallocate > st.st_size) {
+            int ret = posix_fallocate(fd, 0, c->preallocate);
+            if (ret)
+                av_log(h, AV_LOG_WARNING, "Could not preallocate %"PRId64" bytes: %s\n",
+                       c->preallocate, av_err2str(AVERROR(ret)));
+        }
+    } else
+#else
+    if (c->preallocate)
+        av_log(h, AV_LOG_WARNING, "preallocate requires posix_fallocate(), ignoring\n");
+#endif
+    c->preallocate = 0;
+
+    if (c->write_behind && (flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_WRITE) {
+#if HAVE_THREADS
+        int ret = write_behind_open(h);
+        if (ret < 0) {
+            close(fd);
+            return ret;
+        }
+#else
+        av_log(h, AV_LOG_WARNING, "write_behind requires threading support, ignoring\n");
+#endif
+    }
+
     return 0;
 }
 
@@ -250,6 +514,18 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
     FileContext *c = h->priv_data;
     int64_t ret;
 
+#if HAVE_THREADS
+    if (c->wb_fifo) {
+        ret = write_behind_flush(h);
+        if (ret < 0)
+            return ret;
+    }
+#endif
+
+    /* The file size includes the preallocated space. */
+    if (whence == AVSEEK_SIZE && c->preallocate)
+        return c->end;
+
     if (whence == AVSEEK_SIZE) {
         struct stat st;
         ret = fstat(c->fd, &st);
@@ -257,6 +533,8 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
     }
 
     ret = lseek(c->fd, pos, whence);
+    if (ret >= 0)
+        c->pos = ret;
 
     return ret < 0 ? AVERROR(errno) : ret;
 }
@@ -264,8 +542,20 @@ static int64_t file_seek(URLContext *h, int64_t pos, int whence)
 static int file_close(URLContext *h)
 {
     FileContext *c = h->priv_data;
-    int ret = close(c->fd);
-    return (ret == -1) ? AVERROR(errno) : 0;
+    int ret = 0, err;
+
+#if HAVE_THREADS
+    if (c->wb_fifo)
+        ret = write_behind_close(h);
+#endif
+#if HAVE_POSIX_FALLOCATE
+    /* Release the preallocated space which was not written to. */
+    if (c->preallocate && ftruncate(c->fd, c->end) < 0 && !ret)
+        ret = AVERROR(errno);
+#endif
+
+    err = close(c->fd);
+    return (err == -1 && !ret) ? AVERROR(errno) : ret;
 }
 
 static int file_open_dir(URLContext *h)
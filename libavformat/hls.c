@@ -130,6 +130,7 @@ struct playlist {
     int64_t last_seq_no;
     int m3u8_hold_counters;
     int64_t cur_seg_offset;
+    int64_t input_range_end; /* end of the byte range requested for input, or -1 */
     int64_t last_load_time;
 
     /* Currently active Media Initialization Section */
@@ -225,6 +226,7 @@ typedef struct HLSContext {
     int http_persistent;
     int http_multiple;
     int http_seekable;
+    int64_t http_coalesce_size;
     AVIOContext *playlist_pb;
     HLSCryptoContext  crypto_ctx;
 } HLSContext;
@@ -325,6 +327,7 @@ static struct playlist *new_playlist(HLSContext *c, const char *url,
         return NULL;
     }
     pls->seek_timestamp = AV_NOPTS_VALUE;
+    pls->input_range_end = -1;
 
     pls->is_id3_timestamped = -1;
     pls->id3_mpegts_timestamp = AV_NOPTS_VALUE;
@@ -1271,7 +1274,35 @@ static void intercept_id3(struct playlist *pls, uint8_t *buf,
         pls->is_id3_timestamped = (pls->id3_mpegts_timestamp != AV_NOPTS_VALUE);
 }
 
-static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg, AVIOContext **in)
+/* Extend the byte range of seg over the directly following segments that
+ * are contiguous ranges of the same resource, so that they can be fetched
+ * with a single request. */
+static int64_t coalesced_range_end(HLSContext *c, struct playlist *pls,
+                                   struct segment *seg)
+{
+    int64_t end = seg->url_offset + seg->size;
+    int i;
+
+    if (seg->key_type != KEY_NONE)
+        return end;
+
+    for (i = 0; i < pls->n_segments && pls->segments[i] != seg; i++)
+        ;
+    for (i++; i < pls->n_segments; i++) {
+        struct segment *next = pls->segments[i];
+        if (next->size < 0 || next->url_offset != end ||
+            next->key_type != KEY_NONE ||
+            next->init_section != seg->init_section ||
+            strcmp(next->url, seg->url) ||
+            end + next->size - seg->url_offset > c->http_coalesce_size)
+            break;
+        end += next->size;
+    }
+    return end;
+}
+
+static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg,
+                      AVIOContext **in, int64_t *range_end)
 {
     AVDictionary *opts = NULL;
     int ret;
@@ -1280,11 +1311,19 @@ static int open_input(HLSContext *c, struct playlist *pls, struct segment *seg,
     if (c->http_persistent)
         av_dict_set(&opts, "multiple_requests", "1", 0);
 
+    if (range_end)
+        *range_end = -1;
+
     if (seg->size >= 0) {
+        int64_t end = seg->url_offset + seg->size;
+
+        if (range_end && c->http_coalesce_size > 0)
+            end = *range_end = coalesced_range_end(c, pls, seg);
+
         /* try to restrict the HTTP request to the part we want
          * (if this is in fact a HTTP request) */
         av_dict_set_int(&opts, "offset", seg->url_offset, 0);
-        av_dict_set_int(&opts, "end_offset", seg->url_offset + seg->size, 0);
+        av_dict_set_int(&opts, "end_offset", end, 0);
     }
 
     av_log(pls->parent, AV_LOG_VERBOSE, "HLS request for url '%s', offset %"PRId64", playlist %d\n",
@@ -1370,7 +1409,7 @@ static int update_init_section(struct playlist *pls, struct segment *seg)
     if (!seg->init_section)
         return 0;
 
-    ret = open_input(c, pls, seg->init_section, &pls->input);
+    ret = open_input(c, pls, seg->init_section, &pls->input, NULL);
     if (ret < 0) {
         av_log(pls->parent, AV_LOG_WARNING,
                "Failed to open an initialization section in playlist %d\n",
@@ -1464,6 +1503,20 @@ static int playlist_needed(struct playlist *pls)
     return 0;
 }
 
+/* Whether next is read from the current input right after seg, as part of
+ * the byte range requested when seg was opened. */
+static int in_coalesced_range(const struct playlist *v, const struct segment *seg,
+                              const struct segment *next)
+{
+    return v->input_range_end >= 0 && seg && next &&
+           seg->size >= 0 && next->size >= 0 &&
+           next->key_type == KEY_NONE &&
+           next->init_section == seg->init_section &&
+           next->url_offset == seg->url_offset + seg->size &&
+           next->url_offset + next->size <= v->input_range_end &&
+           !strcmp(next->url, seg->url);
+}
+
 static int read_data(void *opaque, uint8_t *buf, int buf_size)
 {
     struct playlist *v = opaque;
@@ -1551,10 +1604,11 @@ reload:
         if (c->http_multiple == 1 && v->input_next_requested) {
             FFSWAP(AVIOContext *, v->input, v->input_next);
             v->cur_seg_offset = 0;
+            v->input_range_end = -1;
             v->input_next_requested = 0;
             ret = 0;
         } else {
-            ret = open_input(c, v, seg, &v->input);
+            ret = open_input(c, v, seg, &v->input, &v->input_range_end);
         }
         if (ret < 0) {
             if (ff_check_interrupt(c->interrupt_callback))
@@ -1579,8 +1633,9 @@ reload:
 
     seg = next_segment(v);
     if (c->http_multiple == 1 && !v->input_next_requested &&
-        seg && seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
-        ret = open_input(c, v, seg, &v->input_next);
+        seg && seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL) &&
+        !in_coalesced_range(v, current_segment(v), seg)) {
+        ret = open_input(c, v, seg, &v->input_next, NULL);
         if (ret < 0) {
             if (ff_check_interrupt(c->interrupt_callback))
                 return AVERROR_EXIT;
@@ -1611,7 +1666,19 @@ reload:
 
         return ret;
     }
+    if (v->cur_seg_offset == seg->size &&
+        in_coalesced_range(v, seg, next_segment(v))) {
+        /* The next segment follows in the data already requested. */
+        v->cur_seq_no++;
+        c->cur_seq_no = v->cur_seq_no;
+        v->cur_seg_offset = 0;
+        just_opened = 1;
+        goto restart;
+    }
+    /* A coalesced request which ended early leaves the connection in an
+     * unknown state, reopen the next segment on its own. */
     if (c->http_persistent &&
+        (v->input_range_end < 0 || v->cur_seg_offset == seg->size) &&
         seg->key_type == KEY_NONE && av_strstart(seg->url, "http", NULL)) {
         v->input_read_done = 1;
     } else {
@@ -2546,6 +2613,8 @@ static const AVOption hls_options[] = {
         OFFSET(http_multiple), AV_OPT_TYPE_BOOL, {.i64 = -1}, -1, 1, FLAGS},
     {"http_seekable", "Use HTTP partial requests, 0 = disable, 1 = enable, -1 = auto",
         OFFSET(http_seekable), AV_OPT_TYPE_BOOL, { .i64 = -1}, -1, 1, FLAGS},
+    {"http_coalesce_size", "Maximum size of a single request for contiguous byte-range segments, 0 = disable",
+        OFFSET(http_coalesce_size), AV_OPT_TYPE_INT64, {.i64 = 0}, 0, INT64_MAX, FLAGS},
     {"seg_format_options", "Set options for segment demuxer",
         OFFSET(seg_format_opts), AV_OPT_TYPE_DICT, {.str = NULL}, 0, 0, FLAGS},
     {NULL}
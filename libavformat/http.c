@@ -33,6 +33,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/time.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
 
 #include "avformat.h"
 #include "http.h"
@@ -52,6 +53,7 @@
 #define BUFFER_SIZE   (MAX_URL_SIZE + HTTP_HEADERS_SIZE)
 #define MAX_REDIRECTS 8
 #define MAX_CACHED_REDIRECTS 32
+#define HTTP_POOL_SIZE 32
 #define HTTP_SINGLE   1
 #define HTTP_MUTLI    2
 #define MAX_EXPIRY    19
@@ -136,6 +138,10 @@ typedef struct HTTPContext {
     char *new_location;
     AVDictionary *redirect_cache;
     uint64_t filesize_from_content_range;
+    int connection_pool;
+    int connection_pool_timeout;
+    int connection_pool_max_per_host;
+    char *pool_key;
 } HTTPContext;
 
 #define OFFSET(x) offsetof(HTTPContext, x)
@@ -178,6 +184,9 @@ static const AVOption options[] = {
     { "resource", "The resource requested by a client", OFFSET(resource), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, E },
     { "reply_code", "The http status code to return to a client", OFFSET(reply_code), AV_OPT_TYPE_INT, { .i64 = 200}, INT_MIN, 599, E},
     { "short_seek_size", "Threshold to favor readahead over seek.", OFFSET(short_seek_size), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, D },
+    { "connection_pool", "keep idle connections in a process-wide pool for reuse by later opens", OFFSET(connection_pool), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, D },
+    { "connection_pool_timeout", "seconds an idle pooled connection is kept", OFFSET(connection_pool_timeout), AV_OPT_TYPE_INT, { .i64 = 15 }, 0, INT_MAX / 1000000, D },
+    { "connection_pool_max_per_host", "maximum number of idle pooled connections per host", OFFSET(connection_pool_max_per_host), AV_OPT_TYPE_INT, { .i64 = 4 }, 1, HTTP_POOL_SIZE, D },
     { NULL }
 };
 
@@ -197,6 +206,168 @@ void ff_http_init_auth_state(URLContext *dest, const URLContext *src)
            sizeof(HTTPAuthState));
 }
 
+/*
+ * Process-wide pool of idle keep-alive connections. An entry is only
+ * handed out to, and only evicted by, contexts using the same interrupt
+ * callback as the one that released it, so a callback whose opaque has
+ * since been freed is never invoked on its behalf.
+ */
+typedef struct HTTPPoolEntry {
+    URLContext *hd;
+    char *key;
+    AVIOInterruptCB int_cb;
+    int64_t expires;
+} HTTPPoolEntry;
+
+static AVMutex http_pool_mutex = AV_MUTEX_INITIALIZER;
+static HTTPPoolEntry http_pool[HTTP_POOL_SIZE];
+
+static int http_pool_owned(const HTTPPoolEntry *e, const AVIOInterruptCB *cb)
+{
+    return e->hd && e->int_cb.callback == cb->callback &&
+                    e->int_cb.opaque   == cb->opaque;
+}
+
+static URLContext *http_pool_take(HTTPPoolEntry *e)
+{
+    URLContext *hd = e->hd;
+    e->hd = NULL;
+    av_freep(&e->key);
+    return hd;
+}
+
+static int http_pool_set_key(URLContext *h, const char *lower_url,
+                             const AVDictionary *options)
+{
+    HTTPContext *s = h->priv_data;
+    char *opts = NULL;
+    int ret;
+
+    /* Options left for the lower protocol (e.g. TLS verification settings)
+     * must match for a connection to be shared. */
+    ret = av_dict_get_string(options, &opts, '=', '&');
+    if (ret < 0)
+        return ret;
+
+    av_freep(&s->pool_key);
+    s->pool_key = av_asprintf("%s?%s|%s|%s", lower_url, opts,
+                              h->protocol_whitelist ? h->protocol_whitelist : "",
+                              h->protocol_blacklist ? h->protocol_blacklist : "");
+    av_free(opts);
+    return s->pool_key ? 0 : AVERROR(ENOMEM);
+}
+
+static URLContext *http_pool_get(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    URLContext *stale[HTTP_POOL_SIZE], *hd = NULL;
+    int64_t now = av_gettime_relative();
+    int nb_stale = 0, best = -1;
+    uint8_t byte;
+
+    ff_mutex_lock(&http_pool_mutex);
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        HTTPPoolEntry *e = &http_pool[i];
+        if (!http_pool_owned(e, &h->interrupt_callback))
+            continue;
+        if (e->expires < now)
+            stale[nb_stale++] = http_pool_take(e);
+        else if (!strcmp(e->key, s->pool_key) &&
+                 (best < 0 || e->expires > http_pool[best].expires))
+            best = i;
+    }
+    if (best >= 0)
+        hd = http_pool_take(&http_pool[best]);
+    ff_mutex_unlock(&http_pool_mutex);
+
+    while (nb_stale)
+        ffurl_closep(&stale[--nb_stale]);
+
+    if (!hd)
+        return NULL;
+
+    /* The server may have closed the connection while it was idle; a
+     * readable socket with no request outstanding means EOF or garbage. */
+    hd->flags |= AVIO_FLAG_NONBLOCK;
+    if (ffurl_read(hd, &byte, 1) != AVERROR(EAGAIN))
+        ffurl_closep(&hd);
+    else
+        hd->flags &= ~AVIO_FLAG_NONBLOCK;
+
+    return hd;
+}
+
+static void http_pool_put(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    URLContext *evict = NULL;
+    int64_t now = av_gettime_relative();
+    int nb_same = 0, slot = -1, oldest_same = -1, oldest = -1;
+    char *key = av_strdup(s->pool_key);
+
+    if (!key) {
+        ffurl_closep(&s->hd);
+        return;
+    }
+
+    ff_mutex_lock(&http_pool_mutex);
+    for (int i = 0; i < HTTP_POOL_SIZE; i++) {
+        HTTPPoolEntry *e = &http_pool[i];
+        if (!e->hd) {
+            if (slot < 0)
+                slot = i;
+            continue;
+        }
+        if (!http_pool_owned(e, &h->interrupt_callback))
+            continue;
+        if (!strcmp(e->key, key)) {
+            nb_same++;
+            if (oldest_same < 0 || e->expires < http_pool[oldest_same].expires)
+                oldest_same = i;
+        }
+        if (oldest < 0 || e->expires < http_pool[oldest].expires)
+            oldest = i;
+    }
+    if (nb_same >= s->connection_pool_max_per_host)
+        slot = oldest_same;
+    else if (slot < 0)
+        slot = oldest;
+
+    if (slot >= 0) {
+        HTTPPoolEntry *e = &http_pool[slot];
+        if (e->hd)
+            evict = http_pool_take(e);
+        e->hd      = s->hd;
+        e->key     = key;
+        e->int_cb  = h->interrupt_callback;
+        e->expires = now + s->connection_pool_timeout * 1000000LL;
+        s->hd      = NULL;
+        key        = NULL;
+    }
+    ff_mutex_unlock(&http_pool_mutex);
+
+    av_free(key);
+    ffurl_closep(&evict);
+    ffurl_closep(&s->hd);
+}
+
+/* Whether the current response has been read completely, leaving the
+ * connection ready for another request. */
+static int http_pool_reusable(URLContext *h)
+{
+    HTTPContext *s = h->priv_data;
+    uint64_t target_end = s->end_off ? s->end_off : s->filesize;
+
+    if (!s->pool_key || s->willclose || s->post_data ||
+        (h->flags & AVIO_FLAG_WRITE) ||
+        s->http_code < 200 || s->http_code >= 300 ||
+        s->buf_ptr != s->buf_end)
+        return 0;
+    if (s->chunksize != UINT64_MAX)
+        return s->chunkend;
+    return target_end != UINT64_MAX && s->off >= target_end;
+}
+
 static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 {
     const char *path, *proxy_path, *lower_proto = "tcp", *local_path;
@@ -206,7 +377,7 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
     char auth[1024], proxyauth[1024] = "";
     char path1[MAX_URL_SIZE], sanitized_path[MAX_URL_SIZE + 1];
     char buf[1024], urlbuf[MAX_URL_SIZE];
-    int port, use_proxy, err = 0;
+    int port, use_proxy, reused = 0, err = 0;
     HTTPContext *s = h->priv_data;
 
     av_url_split(proto, sizeof(proto), auth, sizeof(auth),
@@ -262,16 +433,38 @@ static int http_open_cnx_internal(URLContext *h, AVDictionary **options)
 
     ff_url_join(buf, sizeof(buf), lower_proto, NULL, hostname, port, NULL);
 
+    if (!s->hd && s->connection_pool) {
+        err = http_pool_set_key(h, buf, options ? *options : NULL);
+        if (err < 0)
+            goto end;
+        s->hd = http_pool_get(h);
+        reused = !!s->hd;
+    }
     if (!s->hd) {
         err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
                                    &h->interrupt_callback, options,
                                    h->protocol_whitelist, h->protocol_blacklist, h);
     }
+    if (err < 0)
+        goto end;
+
+    s->line_count = 0;
+    err = http_connect(h, path, local_path, hoststr, auth, proxyauth);
+    if (err < 0 && reused && !s->line_count) {
+        /* The pooled connection was closed before we got a status line,
+         * retry once on a fresh one. */
+        av_log(h, AV_LOG_DEBUG, "Pooled connection to %s failed, reconnecting\n", buf);
+        ffurl_closep(&s->hd);
+        err = ffurl_open_whitelist(&s->hd, buf, AVIO_FLAG_READ_WRITE,
+                                   &h->interrupt_callback, options,
+                                   h->protocol_whitelist, h->protocol_blacklist, h);
+        if (err >= 0)
+            err = http_connect(h, path, local_path, hoststr, auth, proxyauth);
+    }
 
 end:
     freeenv_utf8(env_http_proxy);
-    return err < 0 ? err : http_connect(
-        h, path, local_path, hoststr, auth, proxyauth);
+    return err;
 }
 
 static int http_should_reconnect(HTTPContext *s, int err)
@@ -702,6 +895,10 @@ static int http_open(URLContext *h, const char *uri, int flags,
     if (options)
         av_dict_copy(&s->chained_options, *options, 0);
 
+    /* Pooled connections must be kept alive by the server. */
+    if (s->connection_pool && !s->multiple_requests && !(flags & AVIO_FLAG_WRITE))
+        av_log(h, AV_LOG_WARNING, "connection_pool has no effect without multiple_requests\n");
+
     if (s->headers) {
         int len = strlen(s->headers);
         if (len < 2 || strcmp("\r\n", s->headers + len - 2)) {
@@ -727,6 +924,7 @@ bail_out:
         av_dict_free(&s->redirect_cache);
         av_freep(&s->new_location);
         av_freep(&s->uri);
+        av_freep(&s->pool_key);
     }
     return ret;
 }
@@ -1885,8 +2083,11 @@ static int http_close(URLContext *h)
         /* Close the write direction by sending the end of chunked encoding. */
         ret = http_shutdown(h, h->flags);
 
+    if (s->hd && s->connection_pool && http_pool_reusable(h))
+        http_pool_put(h);
     if (s->hd)
         ffurl_closep(&s->hd);
+    av_freep(&s->pool_key);
     av_dict_free(&s->chained_options);
     av_dict_free(&s->cookie_dict);
     av_dict_free(&s->redirect_cache);
@@ -25,6 +25,7 @@
 #include "libavutil/avstring.h"
 #include "libavutil/opt.h"
 #include "libavutil/parseutils.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 
 #include "avformat.h"
@@ -33,6 +34,7 @@
 #include "os_support.h"
 #include "url.h"
 
+#include <float.h>
 #include <librist/librist.h>
 #include <librist/version.h>
 
@@ -51,6 +53,21 @@ typedef struct RISTContext {
     int fifo_size;
     int overrun_nonfatal;
     char *secret;
+    int64_t stats_interval;
+    int64_t rcv_packets;
+    int64_t rcv_lost;
+    int64_t rcv_recovered;
+    double rcv_rate;
+    double rtt;
+
+    /* Totals updated by the librist statistics thread, copied to the
+     * exported fields above by librist_read(). */
+    AVMutex stats_mutex;
+    int64_t stats_packets;
+    int64_t stats_lost;
+    int64_t stats_recovered;
+    double stats_rate;
+    double stats_rtt;
 
     struct rist_logging_settings logging_settings;
     struct rist_peer_config peer_config;
@@ -74,6 +91,12 @@ static const AVOption librist_options[] = {
     { "log_level",   "set loglevel",    OFFSET(log_level),   AV_OPT_TYPE_INT,   {.i64=RIST_LOG_INFO},        -1, INT_MAX, .flags = D|E },
     { "secret", "set encryption secret",OFFSET(secret),      AV_OPT_TYPE_STRING,{.str=NULL},                  0, 0,       .flags = D|E },
     { "encryption","set encryption type",OFFSET(encryption), AV_OPT_TYPE_INT   ,{.i64=0},                     0, INT_MAX, .flags = D|E },
+    { "stats_interval", "set interval of the receiver statistics updates in microseconds", OFFSET(stats_interval), AV_OPT_TYPE_INT64, {.i64=0}, 0, INT_MAX * 1000LL, .flags = D },
+    { "rcv_packets", "export the number of received packets",  OFFSET(rcv_packets),   AV_OPT_TYPE_INT64,  {.i64=0}, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_lost",    "export the number of lost packets",      OFFSET(rcv_lost),      AV_OPT_TYPE_INT64,  {.i64=0}, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_recovered", "export the number of recovered packets", OFFSET(rcv_recovered), AV_OPT_TYPE_INT64, {.i64=0}, 0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_rate",    "export the receiving rate in Mbps",      OFFSET(rcv_rate),      AV_OPT_TYPE_DOUBLE, {.dbl=0}, 0, DBL_MAX,   AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rtt",         "export the round trip time in milliseconds", OFFSET(rtt),       AV_OPT_TYPE_DOUBLE, {.dbl=0}, 0, DBL_MAX,   AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
     { NULL }
 };
 
@@ -106,6 +129,32 @@ static int log_cb(void *arg, enum rist_log_level log_level, const char *msg)
     return 0;
 }
 
+static int stats_cb(void *arg, const struct rist_stats *stats)
+{
+    URLContext *h = arg;
+    RISTContext *s = h->priv_data;
+
+    if (stats->stats_type == RIST_STATS_RECEIVER_FLOW) {
+        const struct rist_stats_receiver_flow *flow = &stats->stats.receiver_flow;
+
+        /* The packet counters only cover the last interval. */
+        ff_mutex_lock(&s->stats_mutex);
+        s->stats_packets   += flow->received;
+        s->stats_lost      += flow->lost;
+        s->stats_recovered += flow->recovered;
+        s->stats_rate       = flow->bandwidth / 1000000.0;
+        s->stats_rtt        = flow->rtt;
+        av_log(h, AV_LOG_VERBOSE, "received %"PRId64" packets, %"PRId64" lost, "
+               "%"PRId64" recovered, %.3f Mbps, rtt %.1f ms, quality %.1f%%\n",
+               s->stats_packets, s->stats_lost, s->stats_recovered,
+               s->stats_rate, s->stats_rtt, flow->quality);
+        ff_mutex_unlock(&s->stats_mutex);
+    }
+
+    rist_stats_free(stats);
+    return 0;
+}
+
 static int librist_close(URLContext *h)
 {
     RISTContext *s = h->priv_data;
@@ -117,6 +166,8 @@ static int librist_close(URLContext *h)
         ret = rist_destroy(s->ctx);
     s->ctx = NULL;
 
+    ff_mutex_destroy(&s->stats_mutex);
+
     return risterr2ret(ret);
 }
 
@@ -130,10 +181,16 @@ static int librist_open(URLContext *h, const char *uri, int flags)
     if ((flags & AVIO_FLAG_READ_WRITE) == AVIO_FLAG_READ_WRITE)
         return AVERROR(EINVAL);
 
+    ret = ff_mutex_init(&s->stats_mutex, NULL);
+    if (ret)
+        return AVERROR(ret);
+
     s->logging_settings = (struct rist_logging_settings)LOGGING_SETTINGS_INITIALIZER;
     ret = rist_logging_set(&logging_settings, s->log_level, log_cb, h, NULL, NULL);
-    if (ret < 0)
+    if (ret < 0) {
+        ff_mutex_destroy(&s->stats_mutex);
         return risterr2ret(ret);
+    }
 
     if (flags & AVIO_FLAG_WRITE) {
         h->max_packet_size = s->packet_size;
@@ -161,6 +218,13 @@ static int librist_open(URLContext *h, const char *uri, int flags)
         ret = rist_receiver_set_output_fifo_size(s->ctx, s->fifo_size);
         if (ret != 0)
             goto err;
+
+        if (s->stats_interval) {
+            ret = rist_stats_callback_set(s->ctx, FFMAX(s->stats_interval / 1000, 1),
+                                          stats_cb, h);
+            if (ret < 0)
+                goto err;
+        }
     }
 
     if (((s->encryption == 128 || s->encryption == 256) && !s->secret) ||
@@ -203,6 +267,17 @@ static int librist_read(URLContext *h, uint8_t *buf, int size)
     int ret;
 
     struct rist_data_block *data_block;
+
+    if (s->stats_interval) {
+        ff_mutex_lock(&s->stats_mutex);
+        s->rcv_packets   = s->stats_packets;
+        s->rcv_lost      = s->stats_lost;
+        s->rcv_recovered = s->stats_recovered;
+        s->rcv_rate      = s->stats_rate;
+        s->rtt           = s->stats_rtt;
+        ff_mutex_unlock(&s->stats_mutex);
+    }
+
     ret = rist_receiver_data_read2(s->ctx, &data_block, POLLING_TIME);
 
     if (ret < 0)
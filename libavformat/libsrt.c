@@ -21,6 +21,7 @@
  * Haivision Open SRT (Secure Reliable Transport) protocol
  */
 
+#include <float.h>
 #include <srt/srt.h>
 
 #include "libavutil/opt.h"
@@ -91,6 +92,13 @@ typedef struct SRTContext {
     SRT_TRANSTYPE transtype;
     int linger;
     int tsbpd;
+    int64_t stats_interval;
+    int64_t stats_next;
+    int64_t rcv_packets;
+    int64_t rcv_lost;
+    int64_t rcv_dropped;
+    double rcv_rate;
+    double rtt;
 } SRTContext;
 
 #define D AV_OPT_FLAG_DECODING_PARAM
@@ -144,6 +152,12 @@ static const AVOption libsrt_options[] = {
     { "file",           NULL, 0, AV_OPT_TYPE_CONST,  { .i64 = SRTT_FILE }, INT_MIN, INT_MAX, .flags = D|E, "transtype" },
     { "linger",         "Number of seconds that the socket waits for unsent data when closing", OFFSET(linger),           AV_OPT_TYPE_INT,      { .i64 = -1 }, -1, INT_MAX,   .flags = D|E },
     { "tsbpd",          "Timestamp-based packet delivery",                                      OFFSET(tsbpd),            AV_OPT_TYPE_BOOL,     { .i64 = -1 }, -1, 1,         .flags = D|E },
+    { "stats_interval", "Interval of the receiver statistics updates (in microseconds)",       OFFSET(stats_interval),   AV_OPT_TYPE_INT64,    { .i64 = 0 },   0, INT64_MAX, .flags = D },
+    { "rcv_packets",    "export the number of received packets",                                OFFSET(rcv_packets),      AV_OPT_TYPE_INT64,    { .i64 = 0 },   0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_lost",       "export the number of lost packets",                                    OFFSET(rcv_lost),         AV_OPT_TYPE_INT64,    { .i64 = 0 },   0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_dropped",    "export the number of packets dropped for arriving too late",           OFFSET(rcv_dropped),      AV_OPT_TYPE_INT64,    { .i64 = 0 },   0, INT64_MAX, AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rcv_rate",       "export the receiving rate (in Mbps)",                                  OFFSET(rcv_rate),         AV_OPT_TYPE_DOUBLE,   { .dbl = 0 },   0, DBL_MAX,   AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
+    { "rtt",            "export the round trip time (in milliseconds)",                         OFFSET(rtt),              AV_OPT_TYPE_DOUBLE,   { .dbl = 0 },   0, DBL_MAX,   AV_OPT_FLAG_EXPORT | AV_OPT_FLAG_READONLY },
     { NULL }
 };
 
@@ -675,6 +689,26 @@ err:
     return ret;
 }
 
+static void libsrt_update_stats(URLContext *h, int level)
+{
+    SRTContext *s = h->priv_data;
+    SRT_TRACEBSTATS perf;
+
+    if (srt_bstats(s->fd, &perf, 0) < 0)
+        return;
+
+    s->rcv_packets = perf.pktRecvTotal;
+    s->rcv_lost    = perf.pktRcvLossTotal;
+    s->rcv_dropped = perf.pktRcvDropTotal;
+    s->rcv_rate    = perf.mbpsRecvRate;
+    s->rtt         = perf.msRTT;
+
+    av_log(h, level, "received %"PRId64" packets, %"PRId64" lost, %"PRId64" dropped, "
+           "%.3f Mbps, rtt %.1f ms, receive buffer %d ms\n",
+           s->rcv_packets, s->rcv_lost, s->rcv_dropped,
+           s->rcv_rate, s->rtt, perf.msRcvBuf);
+}
+
 static int libsrt_read(URLContext *h, uint8_t *buf, int size)
 {
     SRTContext *s = h->priv_data;
@@ -691,6 +725,14 @@ static int libsrt_read(URLContext *h, uint8_t *buf, int size)
         ret = libsrt_neterrno(h);
     }
 
+    if (s->stats_interval) {
+        int64_t now = av_gettime_relative();
+        if (now >= s->stats_next) {
+            libsrt_update_stats(h, AV_LOG_VERBOSE);
+            s->stats_next = now + s->stats_interval;
+        }
+    }
+
     return ret;
 }
 
@@ -717,6 +759,9 @@ static int libsrt_close(URLContext *h)
 {
     SRTContext *s = h->priv_data;
 
+    if (s->stats_interval && (h->flags & AVIO_FLAG_READ))
+        libsrt_update_stats(h, AV_LOG_VERBOSE);
+
     srt_epoll_release(s->eid);
     srt_close(s->fd);
 
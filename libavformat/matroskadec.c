@@ -1961,6 +1961,60 @@ static void matroska_execute_seekhead(MatroskaDemuxContext *matroska)
     }
 }
 
+/* Enough for a SeekHead with a few entries and a CRC-32. */
+#define TRAILING_SEEKHEAD_MAX_SIZE 256
+
+/**
+ * Look for a SeekHead ending the file if no Cues have been found so far.
+ * Muxers writing to unseekable output (e.g. the matroska muxer with the
+ * live_cues option) cannot update the SeekHead at the start of the file
+ * and append a second one after the Cues instead.
+ */
+static void matroska_parse_trailing_seekhead(MatroskaDemuxContext *matroska)
+{
+    AVIOContext *pb = matroska->ctx->pb;
+    int64_t before_pos = avio_tell(pb);
+    int64_t size = avio_size(pb), start;
+    uint8_t buf[TRAILING_SEEKHEAD_MAX_SIZE];
+    int i, len;
+
+    if (!(pb->seekable & AVIO_SEEKABLE_NORMAL) || size <= 0 ||
+        matroska->ctx->flags & AVFMT_FLAG_IGNIDX)
+        return;
+
+    for (i = 0; i < matroska->num_level1_elems; i++)
+        if (matroska->level1_elems[i].id == MATROSKA_ID_CUES)
+            return;
+
+    start = FFMAX(size - (int64_t)sizeof(buf), before_pos);
+    if (avio_seek(pb, start, SEEK_SET) != start)
+        return;
+    len = avio_read(pb, buf, size - start);
+    if (avio_seek(pb, before_pos, SEEK_SET) != before_pos || len <= 0)
+        return;
+
+    /* The SeekHead must span exactly up to the end of the file. */
+    for (i = len - 5; i >= 0; i--) {
+        uint64_t length;
+        int j, length_size;
+
+        if (AV_RB32(buf + i) != MATROSKA_ID_SEEKHEAD || !buf[i + 4])
+            continue;
+        length_size = 8 - ff_log2_tab[buf[i + 4]];
+        if (i + 4 + length_size > len)
+            continue;
+        length = buf[i + 4] ^ (1 << ff_log2_tab[buf[i + 4]]);
+        for (j = 1; j < length_size; j++)
+            length = (length << 8) | buf[i + 4 + j];
+        if (i + 4 + length_size + length != len)
+            continue;
+
+        if (matroska_parse_seekhead_entry(matroska, start + i) >= 0)
+            matroska_execute_seekhead(matroska);
+        return;
+    }
+}
+
 static void matroska_add_index_entries(MatroskaDemuxContext *matroska)
 {
     EbmlList *index_list;
@@ -3066,6 +3120,7 @@ static int matroska_read_header(AVFormatContext *s)
     if (matroska->current_id == MATROSKA_ID_CLUSTER)
         si->data_offset = avio_tell(matroska->ctx->pb) - 4;
     matroska_execute_seekhead(matroska);
+    matroska_parse_trailing_seekhead(matroska);
 
     if (!matroska->time_scale)
         matroska->time_scale = 1000000;
@@ -246,6 +246,7 @@ typedef struct MatroskaMuxContext {
     int                 flipped_raw_rgb;
     int                 default_mode;
     int                 move_cues_to_front;
+    int                 live_cues;
 
     uint32_t            segment_uid[4];
 } MatroskaMuxContext;
@@ -860,26 +861,14 @@ static void mkv_start_seekhead(MatroskaMuxContext *mkv, AVIOContext *pb)
 }
 
 /**
- * Write the SeekHead to the file at the location reserved for it
- * and seek to destpos afterwards. When error_on_seek_failure
- * is not set, failure to seek to the position designated for the
- * SeekHead is not considered an error and it is presumed that
- * destpos is the current position; failure to seek to destpos
- * afterwards is always an error.
- *
- * @return 0 on success, < 0 on error.
+ * Write a SeekHead containing the current entries at the current position.
  */
-static int mkv_write_seekhead(AVIOContext *pb, MatroskaMuxContext *mkv,
-                              int error_on_seek_failure, int64_t destpos)
+static int mkv_put_seekhead(AVIOContext *pb, MatroskaMuxContext *mkv)
 {
     AVIOContext *dyn_cp = NULL;
     mkv_seekhead *seekhead = &mkv->seekhead;
-    int64_t remaining, ret64;
     int i, ret;
 
-    if ((ret64 = avio_seek(pb, seekhead->filepos, SEEK_SET)) < 0)
-        return error_on_seek_failure ? ret64 : 0;
-
     ret = start_ebml_master_crc32(&dyn_cp, mkv);
     if (ret < 0)
         return ret;
@@ -896,8 +885,31 @@ static int mkv_write_seekhead(AVIOContext *pb, MatroskaMuxContext *mkv,
         put_ebml_uint(dyn_cp, MATROSKA_ID_SEEKPOSITION, entry->segmentpos);
         end_ebml_master(dyn_cp, seekentry);
     }
-    ret = end_ebml_master_crc32(pb, &dyn_cp, mkv,
-                                MATROSKA_ID_SEEKHEAD, 0, 0, 0);
+    return end_ebml_master_crc32(pb, &dyn_cp, mkv,
+                                 MATROSKA_ID_SEEKHEAD, 0, 0, 0);
+}
+
+/**
+ * Write the SeekHead to the file at the location reserved for it
+ * and seek to destpos afterwards. When error_on_seek_failure
+ * is not set, failure to seek to the position designated for the
+ * SeekHead is not considered an error and it is presumed that
+ * destpos is the current position; failure to seek to destpos
+ * afterwards is always an error.
+ *
+ * @return 0 on success, < 0 on error.
+ */
+static int mkv_write_seekhead(AVIOContext *pb, MatroskaMuxContext *mkv,
+                              int error_on_seek_failure, int64_t destpos)
+{
+    mkv_seekhead *seekhead = &mkv->seekhead;
+    int64_t remaining, ret64;
+    int ret;
+
+    if ((ret64 = avio_seek(pb, seekhead->filepos, SEEK_SET)) < 0)
+        return error_on_seek_failure ? ret64 : 0;
+
+    ret = mkv_put_seekhead(pb, mkv);
     if (ret < 0)
         return ret;
 
@@ -2804,7 +2816,7 @@ static int mkv_write_packet_internal(AVFormatContext *s, const AVPacket *pkt)
                           relative_packet_pos);
     if (ret < 0)
         return ret;
-    if (keyframe && IS_SEEKABLE(s->pb, mkv) &&
+    if (keyframe && (IS_SEEKABLE(s->pb, mkv) || mkv->live_cues) &&
         (par->codec_type == AVMEDIA_TYPE_VIDEO    ||
          par->codec_type == AVMEDIA_TYPE_SUBTITLE ||
          !mkv->have_video && !track->has_cue)) {
@@ -2915,6 +2927,38 @@ static int mkv_write_flush_packet(AVFormatContext *s, AVPacket *pkt)
     return mkv_write_packet(s, pkt);
 }
 
+/**
+ * For output that can not be seeked back into, append the Cues after the
+ * last Cluster followed by a second SeekHead referencing them, so that
+ * readers of the complete file can find the index without a remux.
+ */
+static int mkv_write_trailing_index(AVFormatContext *s)
+{
+    MatroskaMuxContext *mkv = s->priv_data;
+    AVIOContext *cues = NULL;
+    int ret;
+
+    if (!mkv->cues.num_entries)
+        return 0;
+
+    ret = start_ebml_master_crc32(&cues, mkv);
+    if (ret < 0)
+        return ret;
+
+    ret = mkv_assemble_cues(s->streams, cues, mkv->tmp_bc, &mkv->cues,
+                            mkv->tracks, s->nb_streams, 0);
+    if (ret < 0) {
+        ffio_free_dyn_buf(&cues);
+        return ret;
+    }
+
+    ret = end_ebml_master_crc32(s->pb, &cues, mkv, MATROSKA_ID_CUES, 0, 0, 1);
+    if (ret < 0)
+        return ret;
+
+    return mkv_put_seekhead(s->pb, mkv);
+}
+
 static int mkv_write_trailer(AVFormatContext *s)
 {
     MatroskaMuxContext *mkv = s->priv_data;
@@ -2944,7 +2988,7 @@ static int mkv_write_trailer(AVFormatContext *s)
         return ret;
 
     if (!IS_SEEKABLE(pb, mkv))
-        return 0;
+        return mkv->live_cues ? mkv_write_trailing_index(s) : 0;
 
     endpos = avio_tell(pb);
 
@@ -3277,6 +3321,7 @@ static const AVCodecTag additional_subtitle_tags[] = {
 static const AVOption options[] = {
     { "reserve_index_space", "Reserve a given amount of space (in bytes) at the beginning of the file for the index (cues).", OFFSET(reserve_cues_space), AV_OPT_TYPE_INT,   { .i64 = 0 },   0, INT_MAX,   FLAGS },
     { "cues_to_front", "Move Cues (the index) to the front by shifting data if necessary", OFFSET(move_cues_to_front), AV_OPT_TYPE_BOOL, { .i64 = 0}, 0, 1, FLAGS },
+    { "live_cues", "Append Cues and a SeekHead at the end of unseekable or live output", OFFSET(live_cues), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, FLAGS },
     { "cluster_size_limit",  "Store at most the provided amount of bytes in a cluster. ",                                     OFFSET(cluster_size_limit), AV_OPT_TYPE_INT  , { .i64 = -1 }, -1, INT_MAX,   FLAGS },
     { "cluster_time_limit",  "Store at most the provided number of milliseconds in a cluster.",                               OFFSET(cluster_time_limit), AV_OPT_TYPE_INT64, { .i64 = -1 }, -1, INT64_MAX, FLAGS },
     { "dash", "Create a WebM file conforming to WebM DASH specification", OFFSET(is_dash), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, FLAGS },
@@ -2950,7 +2950,14 @@ static int mov_read_stsz(MOVContext *c, AVIOContext *pb, MOVAtom atom)
     init_get_bits(&gb, buf, 8*num_bytes);
 
     for (i = 0; i < entries; i++) {
-        sc->sample_sizes[i] = get_bits_long(&gb, field_size);
+        /* byte aligned field sizes are read directly, this table can have
+         * millions of entries for long files */
+        switch (field_size) {
+        case 32: sc->sample_sizes[i] = AV_RB32(buf + 4 * i);           break;
+        case 16: sc->sample_sizes[i] = AV_RB16(buf + 2 * i);           break;
+        case  8: sc->sample_sizes[i] = buf[i];                         break;
+        default: sc->sample_sizes[i] = get_bits_long(&gb, field_size); break;
+        }
         if (sc->sample_sizes[i] < 0) {
             av_free(buf);
             av_log(c->fc, AV_LOG_ERROR, "Invalid sample size %d\n", sc->sample_sizes[i]);
@@ -4110,13 +4117,15 @@ static void mov_build_index(MOVContext *mov, AVStream *st)
 
             memset((uint8_t*)(sc->ctts_data), 0, sc->ctts_allocated_size);
 
+            // The new array is already sized for all samples, fill it directly.
             for (i = 0; i < ctts_count_old &&
                         sc->ctts_count < sc->sample_count; i++)
                 for (j = 0; j < ctts_data_old[i].count &&
-                            sc->ctts_count < sc->sample_count; j++)
-                    add_ctts_entry(&sc->ctts_data, &sc->ctts_count,
-                                   &sc->ctts_allocated_size, 1,
-                                   ctts_data_old[i].duration);
+                            sc->ctts_count < sc->sample_count; j++) {
+                    sc->ctts_data[sc->ctts_count].count    = 1;
+                    sc->ctts_data[sc->ctts_count].duration = ctts_data_old[i].duration;
+                    sc->ctts_count++;
+                }
             av_free(ctts_data_old);
         }
 
@@ -72,6 +72,7 @@ static const AVOption options[] = {
     { "movflags", "MOV muxer flags", offsetof(MOVMuxContext, flags), AV_OPT_TYPE_FLAGS, {.i64 = 0}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "rtphint", "Add RTP hint tracks", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_RTP_HINT}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "moov_size", "maximum moov size so it can be placed at the begin", offsetof(MOVMuxContext, reserved_moov_size), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, 0 },
+    { "moov_size_estimate", "with faststart, add an estimate from the stream durations to moov_size", offsetof(MOVMuxContext, moov_size_estimate), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, AV_OPT_FLAG_ENCODING_PARAM, 0 },
     { "empty_moov", "Make the initial moov atom empty", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_EMPTY_MOOV}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "frag_keyframe", "Fragment at video keyframes", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_KEYFRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
     { "frag_every_frame", "Fragment at every frame", 0, AV_OPT_TYPE_CONST, {.i64 = FF_MOV_FLAG_FRAG_EVERY_FRAME}, INT_MIN, INT_MAX, AV_OPT_FLAG_ENCODING_PARAM, "movflags" },
@@ -6822,6 +6823,46 @@ static int mov_create_dvd_sub_decoder_specific_info(MOVTrack *track,
     return 0;
 }
 
+/**
+ * Compute an upper bound of the size of the moov atom from the durations of
+ * the streams, or return 0 if the duration or rate of a stream is unknown.
+ */
+static int64_t mov_estimate_moov_size(AVFormatContext *s)
+{
+    /* mvhd, udta and the other atoms whose size does not depend on the
+     * number of samples */
+    int64_t size = 4096;
+
+    for (int i = 0; i < s->nb_streams; i++) {
+        AVStream *st = s->streams[i];
+        AVCodecParameters *par = st->codecpar;
+        /* stts, stsz and one stsc and co64 entry per sample */
+        int per_sample = 8 + 4 + 12 + 8;
+        double rate;
+
+        if (st->duration <= 0)
+            return 0;
+        if (par->codec_type == AVMEDIA_TYPE_VIDEO) {
+            rate = av_q2d(st->avg_frame_rate.num ? st->avg_frame_rate : st->r_frame_rate);
+            per_sample += 4;                    // stss
+            if (par->video_delay)
+                per_sample += 8;                // ctts
+        } else if (par->codec_type == AVMEDIA_TYPE_AUDIO && par->sample_rate > 0) {
+            rate = (double)par->sample_rate / (par->frame_size > 0 ? par->frame_size : 1024);
+        } else {
+            return 0;
+        }
+        if (rate <= 0)
+            return 0;
+
+        /* track headers and sample descriptions, including extradata */
+        size += 2048 + par->extradata_size;
+        size += per_sample * (int64_t)(av_q2d(st->time_base) * st->duration * rate + 1);
+    }
+
+    return size;
+}
+
 static int mov_init(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -6881,7 +6922,24 @@ static int mov_init(AVFormatContext *s)
     }
 
     if (mov->flags & FF_MOV_FLAG_FASTSTART) {
-        mov->reserved_moov_size = -1;
+        if (mov->reserved_moov_size > 0 && mov->reserved_moov_size < 8) {
+            av_log(s, AV_LOG_ERROR, "moov_size must be at least 8 bytes "
+                   "when used together with faststart\n");
+            return AVERROR(EINVAL);
+        }
+        if (mov->moov_size_estimate) {
+            int64_t size = mov_estimate_moov_size(s);
+            if (size > 0 && mov->reserved_moov_size + size <= INT_MAX) {
+                av_log(s, AV_LOG_VERBOSE, "Reserving %"PRId64" bytes for the moov atom\n",
+                       mov->reserved_moov_size + size);
+                mov->reserved_moov_size += size;
+            } else {
+                av_log(s, AV_LOG_WARNING, "Could not estimate the moov atom size, "
+                       "it will be moved with a second pass\n");
+            }
+        }
+        if (!mov->reserved_moov_size)
+            mov->reserved_moov_size = -1;
     }
 
     if (mov->use_editlist < 0) {
@@ -7326,7 +7384,7 @@ static int mov_write_header(AVFormatContext *s)
             !mov->max_fragment_duration && !mov->max_fragment_size)
             mov->flags |= FF_MOV_FLAG_FRAG_KEYFRAME;
     } else if (mov->mode != MODE_AVIF) {
-        if (mov->flags & FF_MOV_FLAG_FASTSTART)
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size < 0)
             mov->reserved_header_pos = avio_tell(pb);
         mov_write_mdat_tag(pb, mov);
     }
@@ -7475,6 +7533,27 @@ static int shift_data(AVFormatContext *s)
     return ff_format_shift_data(s, mov->reserved_header_pos, moov_size);
 }
 
+/**
+ * Fill the remainder of the space reserved for the moov atom, which has to
+ * start at the current position and end at end, with a free atom.
+ */
+static int mov_write_reserved_free(AVFormatContext *s, int64_t end)
+{
+    AVIOContext *pb = s->pb;
+    int64_t size = end - avio_tell(pb);
+
+    if (!size)
+        return 0;
+    if (size < 8) {
+        av_log(s, AV_LOG_ERROR, "reserved_moov_size is too small, needed %"PRId64" additional\n", 8-size);
+        return AVERROR(EINVAL);
+    }
+    avio_wb32(pb, size);
+    ffio_wfourcc(pb, "free");
+    ffio_fill(pb, 0, size - 8);
+    return 0;
+}
+
 static int mov_write_trailer(AVFormatContext *s)
 {
     MOVMuxContext *mov = s->priv_data;
@@ -7546,7 +7625,38 @@ static int mov_write_trailer(AVFormatContext *s)
         }
         avio_seek(pb, mov->reserved_moov_size > 0 ? mov->reserved_header_pos : moov_pos, SEEK_SET);
 
-        if (mov->flags & FF_MOV_FLAG_FASTSTART) {
+        if (mov->flags & FF_MOV_FLAG_FASTSTART && mov->reserved_moov_size > 0) {
+            /* Write the moov atom in place if it fits in the reserved space,
+             * only rewrite the whole mdat if it does not. */
+            int moov_size = get_moov_size(s);
+            if (moov_size < 0)
+                return moov_size;
+            if (moov_size == mov->reserved_moov_size ||
+                moov_size + 8 <= mov->reserved_moov_size) {
+                if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
+                    return res;
+                res = mov_write_reserved_free(s, mov->reserved_header_pos +
+                                                 mov->reserved_moov_size);
+                if (res < 0)
+                    return res;
+                avio_seek(pb, moov_pos, SEEK_SET);
+            } else {
+                av_log(s, AV_LOG_INFO, "moov atom does not fit in the reserved %d bytes, "
+                       "starting second pass: moving the moov atom to the beginning of the file\n",
+                       mov->reserved_moov_size);
+                avio_seek(pb, moov_pos, SEEK_SET);
+                res = shift_data(s);
+                if (res < 0)
+                    return res;
+                avio_seek(pb, mov->reserved_header_pos, SEEK_SET);
+                if ((res = mov_write_moov_tag(pb, mov, s)) < 0)
+                    return res;
+                /* the reserved space now follows the moov atom */
+                res = mov_write_reserved_free(s, avio_tell(pb) + mov->reserved_moov_size);
+                if (res < 0)
+                    return res;
+            }
+        } else if (mov->flags & FF_MOV_FLAG_FASTSTART) {
             av_log(s, AV_LOG_INFO, "Starting second pass: moving the moov atom to the beginning of the file\n");
             res = shift_data(s);
             if (res < 0)
@@ -214,6 +214,7 @@ typedef struct MOVMuxContext {
     int video_track_timescale;
 
     int reserved_moov_size; ///< 0 for disabled, -1 for automatic, size otherwise
+    int moov_size_estimate;
     int64_t reserved_header_pos;
 
     char *major_brand;
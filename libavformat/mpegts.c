@@ -42,6 +42,7 @@
 #include "demux.h"
 #include "mpeg.h"
 #include "isom.h"
+#include "seekindex.h"
 #if CONFIG_ICONV
 #include <iconv.h>
 #endif
@@ -165,6 +166,9 @@ struct MpegTSContext {
     int merge_pmt_versions;
     int max_packet_size;
 
+    char *seek_index;
+    int seek_index_loaded;      ///< 1 if the seek index was loaded, -1 if that failed
+
     /******************************************/
     /* private mpegts data */
     /* scan context */
@@ -202,6 +206,8 @@ static const AVOption options[] = {
      {.i64 = 0}, 0, 1, 0 },
     {"max_packet_size", "maximum size of emitted packet", offsetof(MpegTSContext, max_packet_size), AV_OPT_TYPE_INT,
      {.i64 = 204800}, 1, INT_MAX/2, AV_OPT_FLAG_DECODING_PARAM },
+    {"seek_index", "read the seek index from the given file", offsetof(MpegTSContext, seek_index), AV_OPT_TYPE_STRING,
+     {.str = NULL}, 0, 0, AV_OPT_FLAG_DECODING_PARAM },
     { NULL },
 };
 
@@ -2964,6 +2970,39 @@ static void finished_reading_packet(AVFormatContext *s, int raw_packet_size)
         avio_skip(pb, skip);
 }
 
+/**
+ * Handle the packets already present in the I/O buffer in place, stopping at
+ * the first one that is not synchronized.
+ * This avoids the per packet overhead of read_packet() for the common case
+ * of 188 byte packets.
+ */
+static int handle_buffered_packets(MpegTSContext *ts, int64_t *packet_num,
+                                   int64_t nb_packets)
+{
+    AVIOContext *pb = ts->stream->pb;
+    int64_t pos = avio_tell(pb);
+    int ret = 0;
+
+    /* The caller has checked and counted the first packet. */
+    for (;;) {
+        const uint8_t *packet = pb->buf_ptr;
+
+        pb->buf_ptr += TS_PACKET_SIZE;
+        pos         += TS_PACKET_SIZE;
+        ret = handle_packet(ts, packet, pos);
+        if (ret != 0 || ts->stop_parse)
+            break;
+        if (pb->buf_end - pb->buf_ptr < TS_PACKET_SIZE ||
+            pb->buf_ptr[0] != 0x47)
+            break;
+        /* Count the next packet as handle_packets() would. */
+        if (nb_packets != 0 && *packet_num + 1 >= nb_packets)
+            break;
+        ++*packet_num;
+    }
+    return ret;
+}
+
 static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
 {
     AVFormatContext *s = ts->stream;
@@ -3005,6 +3044,15 @@ static int handle_packets(MpegTSContext *ts, int64_t nb_packets)
         if (ts->stop_parse > 0)
             break;
 
+        if (ts->raw_packet_size == TS_PACKET_SIZE &&
+            s->pb->buf_end - s->pb->buf_ptr >= TS_PACKET_SIZE &&
+            s->pb->buf_ptr[0] == 0x47) {
+            ret = handle_buffered_packets(ts, &packet_num, nb_packets);
+            if (ret != 0)
+                break;
+            continue;
+        }
+
         ret = read_packet(s, packet, ts->raw_packet_size, &data);
         if (ret != 0)
             break;
@@ -3296,6 +3344,31 @@ static int mpegts_read_close(AVFormatContext *s)
     return 0;
 }
 
+static int mpegts_read_seek(AVFormatContext *s, int stream_index,
+                            int64_t timestamp, int flags)
+{
+    MpegTSContext *ts = s->priv_data;
+
+    if (!ts->seek_index)
+        return -1;
+    /* Streams may be added after the header, so only load the index when
+     * it is needed. */
+    if (!ts->seek_index_loaded) {
+        int64_t pos = avio_tell(s->pb);
+        ts->seek_index_loaded = 1;
+        if (ff_seek_index_read(s, ts->seek_index) < 0) {
+            av_log(s, AV_LOG_WARNING, "Falling back to seeking without the seek index\n");
+            ts->seek_index_loaded = -1;
+        }
+        avio_seek(s->pb, pos, SEEK_SET);
+    }
+    /* The binary search also adds index entries, do not mistake them for
+     * a seek index. */
+    if (ts->seek_index_loaded < 0)
+        return -1;
+    return ff_seek_index_seek(s, stream_index, timestamp, flags);
+}
+
 static av_unused int64_t mpegts_get_pcr(AVFormatContext *s, int stream_index,
                               int64_t *ppos, int64_t pos_limit)
 {
@@ -3432,6 +3505,7 @@ const AVInputFormat ff_mpegts_demuxer = {
     .read_header    = mpegts_read_header,
     .read_packet    = mpegts_read_packet,
     .read_close     = mpegts_read_close,
+    .read_seek      = mpegts_read_seek,
     .read_timestamp = mpegts_get_dts,
     .flags          = AVFMT_SHOW_IDS | AVFMT_TS_DISCONT,
     .priv_class     = &mpegts_class,
@@ -124,9 +124,17 @@ typedef struct MpegTSWrite {
     uint8_t provider_name[256];
 
     int omit_video_pes_length;
+
+    /* TS packets waiting to be written with a single avio_write() */
+    uint8_t *out_buf;
+    int out_len;
 } MpegTSWrite;
 
 /* a PES packet header is generated every DEFAULT_PES_HEADER_FREQ packets */
+/* number of packets that can be batched in MpegTSWrite.out_buf */
+#define OUT_BUF_PACKETS 64
+#define OUT_BUF_SIZE (OUT_BUF_PACKETS * (TS_PACKET_SIZE + 4))
+
 #define DEFAULT_PES_HEADER_FREQ  16
 #define DEFAULT_PES_PAYLOAD_SIZE ((DEFAULT_PES_HEADER_FREQ - 1) * 184 + 170)
 
@@ -951,20 +959,59 @@ static int64_t get_pcr(const MpegTSWrite *ts)
            ts->first_pcr;
 }
 
-static void write_packet(AVFormatContext *s, const uint8_t *packet)
+/* write the batched packets to the output */
+static void flush_packets(AVFormatContext *s)
 {
     MpegTSWrite *ts = s->priv_data;
+
+    if (!ts->out_len)
+        return;
+    if (s->pb->direct) {
+        /* keep one write per packet, as each write may be a datagram */
+        int size = TS_PACKET_SIZE + (ts->m2ts_mode ? 4 : 0);
+        for (int i = 0; i < ts->out_len; i += size)
+            avio_write(s->pb, ts->out_buf + i, size);
+    } else {
+        avio_write(s->pb, ts->out_buf, ts->out_len);
+    }
+    ts->out_len = 0;
+}
+
+/**
+ * Get room for the next packet in the output batch.
+ * The packet must be completed with commit_packet() before writing any
+ * other packet.
+ */
+static uint8_t *get_packet_buffer(AVFormatContext *s)
+{
+    MpegTSWrite *ts = s->priv_data;
+    uint8_t *q;
+
+    if (ts->out_len + TS_PACKET_SIZE + 4 > OUT_BUF_SIZE)
+        flush_packets(s);
+    q = ts->out_buf + ts->out_len;
     if (ts->m2ts_mode) {
         int64_t pcr = get_pcr(s->priv_data);
-        uint32_t tp_extra_header = pcr % 0x3fffffff;
-        tp_extra_header = AV_RB32(&tp_extra_header);
-        avio_write(s->pb, (unsigned char *) &tp_extra_header,
-                   sizeof(tp_extra_header));
+        AV_WB32(q, pcr % 0x3fffffff);
+        q += 4;
     }
-    avio_write(s->pb, packet, TS_PACKET_SIZE);
+    return q;
+}
+
+static void commit_packet(AVFormatContext *s)
+{
+    MpegTSWrite *ts = s->priv_data;
+
+    ts->out_len    += TS_PACKET_SIZE + (ts->m2ts_mode ? 4 : 0);
     ts->total_size += TS_PACKET_SIZE;
 }
 
+static void write_packet(AVFormatContext *s, const uint8_t *packet)
+{
+    memcpy(get_packet_buffer(s), packet, TS_PACKET_SIZE);
+    commit_packet(s);
+}
+
 static void section_write_packet(MpegTSSection *s, const uint8_t *packet)
 {
     AVFormatContext *ctx = s->opaque;
@@ -1084,6 +1131,10 @@ static int mpegts_init(AVFormatContext *s)
     int i, j;
     int ret;
 
+    ts->out_buf = av_malloc(OUT_BUF_SIZE);
+    if (!ts->out_buf)
+        return AVERROR(ENOMEM);
+
     if (ts->m2ts_mode == -1) {
         if (av_match_ext(s->url, "m2ts")) {
             ts->m2ts_mode = 1;
@@ -1469,8 +1520,7 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
 {
     MpegTSWriteStream *ts_st = st->priv_data;
     MpegTSWrite *ts = s->priv_data;
-    uint8_t buf[TS_PACKET_SIZE];
-    uint8_t *q;
+    uint8_t *buf, *q;
     int val, is_start, len, header_len, write_pcr, flags;
     int afc_len, stuffing_len;
     int is_dvb_subtitle = (st->codecpar->codec_id == AV_CODEC_ID_DVB_SUBTITLE);
@@ -1480,7 +1530,6 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
     int force_sdt = 0;
     int force_nit = 0;
 
-    av_assert0(ts_st->payload != buf || st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO);
     if (ts->flags & MPEGTS_FLAG_PAT_PMT_AT_FRAMES && st->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
         force_pat = 1;
     }
@@ -1548,7 +1597,8 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
             }
         }
 
-        /* prepare packet header */
+        /* prepare packet header, directly in the output batch */
+        buf  = get_packet_buffer(s);
         q    = buf;
         *q++ = 0x47;
         val  = ts_st->pid >> 8;
@@ -1743,9 +1793,10 @@ static void mpegts_write_pes(AVFormatContext *s, AVStream *st,
 
         payload      += len;
         payload_size -= len;
-        write_packet(s, buf);
+        commit_packet(s);
     }
     ts_st->prev_payload_key = key;
+    flush_packets(s);
 }
 
 int ff_check_h264_startcode(AVFormatContext *s, const AVStream *st, const AVPacket *pkt)
@@ -2161,20 +2212,26 @@ static void mpegts_write_flush(AVFormatContext *s)
     }
 
     if (ts->m2ts_mode) {
-        int packets = (avio_tell(s->pb) / (TS_PACKET_SIZE + 4)) % 32;
+        int packets;
+        flush_packets(s);
+        packets = (avio_tell(s->pb) / (TS_PACKET_SIZE + 4)) % 32;
         while (packets++ < 32)
             mpegts_insert_null_packet(s);
     }
+    flush_packets(s);
 }
 
 static int mpegts_write_packet(AVFormatContext *s, AVPacket *pkt)
 {
+    int ret;
+
     if (!pkt) {
         mpegts_write_flush(s);
         return 1;
-    } else {
-        return mpegts_write_packet_internal(s, pkt);
     }
+    ret = mpegts_write_packet_internal(s, pkt);
+    flush_packets(s);
+    return ret;
 }
 
 static int mpegts_write_end(AVFormatContext *s)
@@ -2191,6 +2248,7 @@ static void mpegts_deinit(AVFormatContext *s)
     MpegTSService *service;
     int i;
 
+    av_freep(&ts->out_buf);
     for (i = 0; i < s->nb_streams; i++) {
         AVStream *st = s->streams[i];
         MpegTSWriteStream *ts_st = st->priv_data;
@@ -55,20 +55,20 @@ int avformat_query_codec(const AVOutputFormat *ofmt, enum AVCodecID codec_id,
     return AVERROR_PATCHWELCOME;
 }
 
+#define SHIFT_BLOCK_SIZE (1 << 20)
+
 int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
 {
     int ret;
-    int64_t pos, pos_end;
-    uint8_t *buf, *read_buf[2];
-    int read_buf_id = 0;
-    int read_size[2];
+    int64_t pos_end, total, read_pos = 0, write_pos = 0;
+    size_t buf_size = (size_t)shift_size + SHIFT_BLOCK_SIZE;
+    uint8_t *buf;
     AVIOContext *read_pb;
+    int eof = 0;
 
-    buf = av_malloc_array(shift_size, 2);
+    buf = av_malloc(buf_size);
     if (!buf)
         return AVERROR(ENOMEM);
-    read_buf[0] = buf;
-    read_buf[1] = buf + shift_size;
 
     /* Shift the data: the AVIO context of the output can only be used for
      * writing, so we re-open the same output, but for reading. It also avoids
@@ -86,24 +86,35 @@ int ff_format_shift_data(AVFormatContext *s, int64_t read_start, int shift_size)
     avio_seek(s->pb, read_start + shift_size, SEEK_SET);
 
     avio_seek(read_pb, read_start, SEEK_SET);
-    pos = avio_tell(read_pb);
-
-#define READ_BLOCK do {                                                             \
-    read_size[read_buf_id] = avio_read(read_pb, read_buf[read_buf_id], shift_size);  \
-    read_buf_id ^= 1;                                                               \
-} while (0)
-
-    /* shift data by chunk of at most shift_size */
-    READ_BLOCK;
-    do {
-        int n;
-        READ_BLOCK;
-        n = read_size[read_buf_id];
-        if (n <= 0)
-            break;
-        avio_write(s->pb, read_buf[read_buf_id], n);
-        pos += n;
-    } while (pos < pos_end);
+    total = pos_end - read_start;
+
+    /* Copy in a single pass through a ring buffer, in blocks independent of
+     * shift_size. read_pos and write_pos count the bytes of the shifted range
+     * read into and written out of the buffer; a byte can only be written
+     * once the data it overwrites has been read, so the writer stays
+     * shift_size bytes behind the reader until the end of the data. */
+    while (write_pos < read_pos || !eof) {
+        int64_t limit;
+
+        while (!eof && read_pos - write_pos < buf_size) {
+            size_t off = read_pos % buf_size;
+            int len = FFMIN3(FFMIN(buf_size - off, SHIFT_BLOCK_SIZE),
+                             buf_size - (read_pos - write_pos), total - read_pos);
+            int n = len > 0 ? avio_read(read_pb, buf + off, len) : 0;
+            if (n <= 0)
+                eof = 1;
+            else
+                read_pos += n;
+        }
+
+        limit = eof ? read_pos : read_pos - shift_size;
+        while (write_pos < limit) {
+            size_t off = write_pos % buf_size;
+            int len = FFMIN3(buf_size - off, limit - write_pos, SHIFT_BLOCK_SIZE);
+            avio_write(s->pb, buf + off, len);
+            write_pos += len;
+        }
+    }
     ret = ff_format_io_close(s, &read_pb);
 
 end:
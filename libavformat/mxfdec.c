@@ -281,6 +281,7 @@ typedef struct MXFIndexTable {
     int64_t *ptses;             /* maps EditUnit -> PTS */
     int nb_segments;
     MXFIndexTableSegment **segments;    /* sorted by IndexStartPosition */
+    int64_t *segment_offsets;   /* CBR StreamOffset at the start of each segment, NULL if segments overlap */
     AVIndexEntry *fake_index;   /* used for calling ff_index_search_timestamp() */
     int8_t *offsets;            /* temporal offsets for display order to stored order conversion */
 } MXFIndexTable;
@@ -1841,7 +1842,28 @@ static int mxf_edit_unit_absolute_offset(MXFContext *mxf, MXFIndexTable *index_t
 
     edit_unit = av_rescale_q(edit_unit, index_table->segments[0]->index_edit_rate, edit_rate);
 
-    for (i = 0; i < index_table->nb_segments; i++) {
+    i = 0;
+    if (index_table->segment_offsets) {
+        /* find the first segment ending after edit_unit; for disjoint
+         * segments this is where the linear search below would stop */
+        int a = -1, b = index_table->nb_segments;
+
+        while (b - a > 1) {
+            int m = (a + b) >> 1;
+            MXFIndexTableSegment *s = index_table->segments[m];
+
+            if (edit_unit < (int64_t)(s->index_start_position + s->index_duration))
+                b = m;
+            else
+                a = m;
+        }
+        if (b < index_table->nb_segments) {
+            i           = b;
+            offset_temp = index_table->segment_offsets[b];
+        }
+    }
+
+    for (; i < index_table->nb_segments; i++) {
         MXFIndexTableSegment *s = index_table->segments[i];
 
         edit_unit = FFMAX(edit_unit, s->index_start_position);  /* clamp if trying to seek before start */
@@ -2000,6 +2022,37 @@ static int mxf_compute_ptses_fake_index(MXFContext *mxf, MXFIndexTable *index_ta
     return 0;
 }
 
+/**
+ * Set up the bisection lookup of mxf_edit_unit_absolute_offset() if the
+ * segments of the table are non-empty and do not overlap.
+ */
+static int mxf_init_segment_offsets(MXFIndexTable *t)
+{
+    int64_t offset = 0;
+
+    for (int k = 0; k < t->nb_segments; k++) {
+        MXFIndexTableSegment *s = t->segments[k];
+
+        if (!s->index_duration || s->index_duration > INT64_MAX ||
+            (k && s->index_start_position < t->segments[k - 1]->index_start_position +
+                                            t->segments[k - 1]->index_duration))
+            return 0;
+    }
+
+    t->segment_offsets = av_malloc_array(t->nb_segments, sizeof(*t->segment_offsets));
+    if (!t->segment_offsets)
+        return AVERROR(ENOMEM);
+
+    for (int k = 0; k < t->nb_segments; k++) {
+        MXFIndexTableSegment *s = t->segments[k];
+
+        t->segment_offsets[k] = offset;
+        offset += s->edit_unit_byte_count * s->index_duration;
+    }
+
+    return 0;
+}
+
 /**
  * Sorts and collects index table segments into index tables.
  * Also computes PTSes if possible.
@@ -2102,6 +2155,9 @@ static int mxf_compute_index_tables(MXFContext *mxf)
             t->segments[k]->index_duration = mxf_track->original_duration;
             break;
         }
+
+        if ((ret = mxf_init_segment_offsets(t)) < 0)
+            goto finish_decoding_index;
     }
 
     ret = 0;
@@ -4035,6 +4091,7 @@ static int mxf_read_close(AVFormatContext *s)
     if (mxf->index_tables) {
         for (i = 0; i < mxf->nb_index_tables; i++) {
             av_freep(&mxf->index_tables[i].segments);
+            av_freep(&mxf->index_tables[i].segment_offsets);
             av_freep(&mxf->index_tables[i].ptses);
             av_freep(&mxf->index_tables[i].fake_index);
             av_freep(&mxf->index_tables[i].offsets);
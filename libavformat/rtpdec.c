@@ -777,12 +777,41 @@ static int rtp_parse_packet_internal(RTPDemuxContext *s, AVPacket *pkt,
     return rv;
 }
 
+/**
+ * Get an unused slot of the reordering queue. The slots and their buffers
+ * are allocated once and recycled, so that reordering does not allocate
+ * memory for every out of order packet.
+ */
+static RTPPacket *get_queue_slot(RTPDemuxContext *s)
+{
+    RTPPacket *packet;
+
+    if (!s->queue_pool) {
+        s->queue_pool = av_calloc(s->queue_size, sizeof(*s->queue_pool));
+        if (!s->queue_pool)
+            return NULL;
+        for (int i = 0; i < s->queue_size - 1; i++)
+            s->queue_pool[i].next = &s->queue_pool[i + 1];
+        s->queue_free = s->queue_pool;
+    }
+
+    packet = s->queue_free;
+    if (packet)
+        s->queue_free = packet->next;
+    return packet;
+}
+
+static void put_queue_slot(RTPDemuxContext *s, RTPPacket *packet)
+{
+    packet->next  = s->queue_free;
+    s->queue_free = packet;
+}
+
 void ff_rtp_reset_packet_queue(RTPDemuxContext *s)
 {
     while (s->queue) {
         RTPPacket *next = s->queue->next;
-        av_freep(&s->queue->buf);
-        av_freep(&s->queue);
+        put_queue_slot(s, s->queue);
         s->queue = next;
     }
     s->seq       = 0;
@@ -790,7 +819,7 @@ void ff_rtp_reset_packet_queue(RTPDemuxContext *s)
     s->prev_ret  = 0;
 }
 
-static int enqueue_packet(RTPDemuxContext *s, uint8_t *buf, int len)
+static int enqueue_packet(RTPDemuxContext *s, const uint8_t *buf, int len)
 {
     uint16_t seq   = AV_RB16(buf + 2);
     RTPPacket **cur = &s->queue, *packet;
@@ -803,13 +832,18 @@ static int enqueue_packet(RTPDemuxContext *s, uint8_t *buf, int len)
         cur = &(*cur)->next;
     }
 
-    packet = av_mallocz(sizeof(*packet));
+    packet = get_queue_slot(s);
     if (!packet)
         return AVERROR(ENOMEM);
+    av_fast_malloc(&packet->buf, &packet->buf_size, len);
+    if (!packet->buf) {
+        put_queue_slot(s, packet);
+        return AVERROR(ENOMEM);
+    }
+    memcpy(packet->buf, buf, len);
     packet->recvtime = av_gettime_relative();
     packet->seq      = seq;
     packet->len      = len;
-    packet->buf      = buf;
     packet->next     = *cur;
     *cur = packet;
     s->queue_len++;
@@ -847,8 +881,7 @@ static int rtp_parse_queued_packet(RTPDemuxContext *s, AVPacket *pkt)
     /* Parse the first packet in the queue, and dequeue it */
     rv   = rtp_parse_packet_internal(s, pkt, s->queue->buf, s->queue->len);
     next = s->queue->next;
-    av_freep(&s->queue->buf);
-    av_freep(&s->queue);
+    put_queue_slot(s, s->queue);
     s->queue = next;
     s->queue_len--;
     return rv;
@@ -920,7 +953,6 @@ static int rtp_parse_one_packet(RTPDemuxContext *s, AVPacket *pkt,
             rv = enqueue_packet(s, buf, len);
             if (rv < 0)
                 return rv;
-            *bufptr = NULL;
             /* Return the first enqueued packet if the queue is full,
              * even if we're missing something */
             if (s->queue_len >= s->queue_size) {
@@ -957,6 +989,11 @@ int ff_rtp_parse_packet(RTPDemuxContext *s, AVPacket *pkt,
 void ff_rtp_parse_close(RTPDemuxContext *s)
 {
     ff_rtp_reset_packet_queue(s);
+    if (s->queue_pool) {
+        for (int i = 0; i < s->queue_size; i++)
+            av_freep(&s->queue_pool[i].buf);
+        av_freep(&s->queue_pool);
+    }
     ff_srtp_free(&s->srtp);
     av_free(s);
 }
@@ -140,6 +140,7 @@ struct RTPDynamicProtocolHandler {
 typedef struct RTPPacket {
     uint16_t seq;
     uint8_t *buf;
+    unsigned int buf_size; ///< Allocated size of buf, kept when the slot is reused
     int len;
     int64_t recvtime;
     struct RTPPacket *next;
@@ -170,6 +171,8 @@ struct RTPDemuxContext {
     RTPPacket* queue; ///< A sorted queue of buffered packets not yet returned
     int queue_len;    ///< The number of packets in queue
     int queue_size;   ///< The size of queue, or 0 if reordering is disabled
+    RTPPacket *queue_pool; ///< queue_size preallocated slots backing the queue
+    RTPPacket *queue_free; ///< List of the unused slots in queue_pool
     /*@}*/
 
     /* rtcp sender statistics receive */
@@ -65,6 +65,7 @@ int ff_add_index_entry(AVIndexEntry **index_entries,
 {
     AVIndexEntry *entries, *ie;
     int index;
+    size_t min_size_needed, requested_size;
 
     if ((unsigned) *nb_index_entries + 1 >= UINT_MAX / sizeof(AVIndexEntry))
         return -1;
@@ -78,10 +79,26 @@ int ff_add_index_entry(AVIndexEntry **index_entries,
     if (is_relative(timestamp)) //FIXME this maintains previous behavior but we should shift by the correct offset once known
         timestamp -= RELATIVE_TS_BASE;
 
+    /* Grow the array geometrically: demuxers building a full index while
+     * reading the header (avi, matroska cues) can add millions of entries,
+     * and the small fixed overallocation of av_fast_realloc() would copy
+     * the whole array over and over. */
+    min_size_needed = (*nb_index_entries + 1) * sizeof(AVIndexEntry);
+    requested_size  = min_size_needed > *index_entries_allocated_size ?
+                      FFMAX(min_size_needed, 2 * (size_t)*index_entries_allocated_size) :
+                      min_size_needed;
+    if (requested_size > UINT_MAX)
+        requested_size = min_size_needed;
+
     entries = av_fast_realloc(*index_entries,
                               index_entries_allocated_size,
-                              (*nb_index_entries + 1) *
-                              sizeof(AVIndexEntry));
+                              requested_size);
+    /* The doubled size may exceed the allocation limit while the exact
+     * size still fits, the array itself is untouched on failure. */
+    if (!entries && requested_size > min_size_needed)
+        entries = av_fast_realloc(*index_entries,
+                                  index_entries_allocated_size,
+                                  min_size_needed);
     if (!entries)
         return -1;
 
@@ -0,0 +1,125 @@
+/*
+ * Seek index sidecar files
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <inttypes.h>
+
+#include "libavutil/mem.h"
+
+#include "avformat.h"
+#include "demux.h"
+#include "internal.h"
+#include "seekindex.h"
+
+typedef struct SeekIndexEntry {
+    int stream_index;
+    int64_t dts, pos;
+} SeekIndexEntry;
+
+int ff_seek_index_read(AVFormatContext *s, const char *url)
+{
+    AVIOContext *pb = NULL;
+    SeekIndexEntry *entries = NULL;
+    char line[256];
+    int nb_entries = 0, ret;
+
+    ret = s->io_open(s, &pb, url, AVIO_FLAG_READ, NULL);
+    if (ret < 0) {
+        av_log(s, AV_LOG_WARNING, "Unable to open seek index '%s'\n", url);
+        return ret;
+    }
+
+    ff_get_chomp_line(pb, line, sizeof(line));
+    if (strcmp(line, FF_SEEK_INDEX_TAG)) {
+        av_log(s, AV_LOG_WARNING, "'%s' is not a seek index\n", url);
+        ret = AVERROR_INVALIDDATA;
+        goto end;
+    }
+
+    /* Collect all entries first, so that an invalid file does not leave
+     * a partial index behind. */
+    while (!avio_feof(pb)) {
+        SeekIndexEntry e;
+
+        if (!ff_get_chomp_line(pb, line, sizeof(line)))
+            continue;
+        if (sscanf(line, "%d %"SCNd64" %"SCNd64, &e.stream_index, &e.dts, &e.pos) != 3 ||
+            e.pos < 0 || e.dts == AV_NOPTS_VALUE) {
+            av_log(s, AV_LOG_WARNING, "Invalid seek index entry '%s'\n", line);
+            ret = AVERROR_INVALIDDATA;
+            goto end;
+        }
+        if (e.stream_index < 0 || e.stream_index >= s->nb_streams)
+            continue;
+        if (av_dynarray2_add((void **)&entries, &nb_entries,
+                             sizeof(*entries), (const uint8_t *)&e) == NULL) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+    }
+    if (pb->error < 0) {
+        ret = pb->error;
+        goto end;
+    }
+
+    for (int i = 0; i < nb_entries; i++) {
+        ret = av_add_index_entry(s->streams[entries[i].stream_index],
+                                 entries[i].pos, entries[i].dts,
+                                 0, 0, AVINDEX_KEYFRAME);
+        if (ret < 0)
+            goto end;
+    }
+    ret = nb_entries;
+    av_log(s, AV_LOG_VERBOSE, "Loaded %d seek index entries from '%s'\n",
+           nb_entries, url);
+
+end:
+    av_free(entries);
+    ff_format_io_close(s, &pb);
+    return ret;
+}
+
+int ff_seek_index_seek(AVFormatContext *s, int stream_index,
+                       int64_t timestamp, int flags)
+{
+    AVStream *st;
+    FFStream *sti;
+    const AVIndexEntry *ie;
+    int index;
+    int64_t ret;
+
+    if (stream_index < 0 || stream_index >= s->nb_streams)
+        return -1;
+    st  = s->streams[stream_index];
+    sti = ffstream(st);
+    if (sti->nb_index_entries < 2 ||
+        timestamp < sti->index_entries[0].timestamp ||
+        timestamp > sti->index_entries[sti->nb_index_entries - 1].timestamp)
+        return -1;
+
+    index = av_index_search_timestamp(st, timestamp, flags);
+    if (index < 0)
+        return -1;
+    ie = &sti->index_entries[index];
+
+    if ((ret = avio_seek(s->pb, ie->pos, SEEK_SET)) < 0)
+        return ret;
+    avpriv_update_cur_dts(s, st, ie->timestamp);
+    return 0;
+}
@@ -0,0 +1,52 @@
+/*
+ * Seek index sidecar files
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFORMAT_SEEKINDEX_H
+#define AVFORMAT_SEEKINDEX_H
+
+#include "avformat.h"
+
+/**
+ * A seek index file is a text file starting with the line
+ * "ffseekindex 1", followed by one line per keyframe of the form
+ * "<stream index> <dts> <byte position>", the dts being expressed in the
+ * time base of the stream. tools/seekindex generates such files.
+ */
+#define FF_SEEK_INDEX_TAG "ffseekindex 1"
+
+/**
+ * Add the entries of a seek index file to the index of the streams of s.
+ * Entries for streams that do not exist in s are ignored.
+ *
+ * @return the number of entries added, or a negative error code
+ */
+int ff_seek_index_read(AVFormatContext *s, const char *url);
+
+/**
+ * Seek using only the index of a stream, without reading any data.
+ * Fails if the target timestamp is not between two index entries, in which
+ * case the caller should fall back to its usual seeking method.
+ *
+ * @return >= 0 on success, a negative value otherwise
+ */
+int ff_seek_index_seek(AVFormatContext *s, int stream_index,
+                       int64_t timestamp, int flags);
+
+#endif /* AVFORMAT_SEEKINDEX_H */
@@ -0,0 +1,181 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that the http connection_pool option reuses connections.
+ *
+ * A minimal keep-alive HTTP server is run from the interrupt callback,
+ * which the blocking socket operations of the client call regularly, so
+ * that no thread is needed.
+ */
+
+#include <string.h>
+
+#include "libavutil/dict.h"
+#include "libavutil/error.h"
+#include "libavformat/avformat.h"
+#include "libavformat/network.h"
+
+#define MAX_CLIENTS 8
+
+static const char response[] = "HTTP/1.1 200 OK\r\n"
+                               "Content-Type: text/plain\r\n"
+                               "Content-Length: 6\r\n"
+                               "\r\n"
+                               "pooled";
+
+typedef struct Server {
+    int listen_fd;
+    int fds[MAX_CLIENTS];
+    char bufs[MAX_CLIENTS][1024];
+    int buf_len[MAX_CLIENTS];
+    int nb_connections;
+    int nb_requests;
+} Server;
+
+static void serve_client(Server *srv, int i)
+{
+    char *end;
+    int n = recv(srv->fds[i], srv->bufs[i] + srv->buf_len[i],
+                 sizeof(srv->bufs[i]) - 1 - srv->buf_len[i], 0);
+
+    if (n <= 0) {
+        closesocket(srv->fds[i]);
+        srv->fds[i] = -1;
+        return;
+    }
+    srv->buf_len[i] += n;
+    srv->bufs[i][srv->buf_len[i]] = 0;
+
+    while ((end = strstr(srv->bufs[i], "\r\n\r\n"))) {
+        int len = end + 4 - srv->bufs[i];
+        send(srv->fds[i], response, sizeof(response) - 1, 0);
+        srv->nb_requests++;
+        srv->buf_len[i] -= len;
+        memmove(srv->bufs[i], srv->bufs[i] + len, srv->buf_len[i] + 1);
+    }
+}
+
+static int serve(void *opaque)
+{
+    Server *srv = opaque;
+    struct pollfd p[MAX_CLIENTS + 1];
+    int idx[MAX_CLIENTS + 1];
+    int nb = 0;
+
+    p[nb++] = (struct pollfd){ .fd = srv->listen_fd, .events = POLLIN };
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (srv->fds[i] < 0)
+            continue;
+        idx[nb] = i;
+        p[nb++] = (struct pollfd){ .fd = srv->fds[i], .events = POLLIN };
+    }
+    if (poll(p, nb, 0) <= 0)
+        return 0;
+
+    for (int j = 1; j < nb; j++)
+        if (p[j].revents)
+            serve_client(srv, idx[j]);
+
+    if (p[0].revents & POLLIN) {
+        int fd = accept(srv->listen_fd, NULL, NULL);
+        for (int i = 0; i < MAX_CLIENTS && fd >= 0; i++) {
+            if (srv->fds[i] < 0) {
+                srv->fds[i]     = fd;
+                srv->buf_len[i] = 0;
+                srv->nb_connections++;
+                fd = -1;
+            }
+        }
+        if (fd >= 0)
+            closesocket(fd);
+    }
+    return 0;
+}
+
+static int run(Server *srv, int port, int pool)
+{
+    AVIOInterruptCB int_cb = { serve, srv };
+    char url[64], buf[16];
+    int ret = 0;
+
+    srv->nb_connections = srv->nb_requests = 0;
+    snprintf(url, sizeof(url), "http://127.0.0.1:%d/test", port);
+
+    for (int i = 0; i < 3; i++) {
+        AVIOContext *pb = NULL;
+        AVDictionary *opts = NULL;
+
+        av_dict_set_int(&opts, "connection_pool", pool, 0);
+        av_dict_set_int(&opts, "multiple_requests", 1, 0);
+        ret = avio_open2(&pb, url, AVIO_FLAG_READ, &int_cb, &opts);
+        av_dict_free(&opts);
+        if (ret < 0)
+            break;
+        ret = avio_read(pb, buf, sizeof(buf));
+        if (ret != 6 || memcmp(buf, "pooled", 6) || avio_read(pb, buf, 1) != AVERROR_EOF)
+            ret = AVERROR_INVALIDDATA;
+        avio_closep(&pb);
+        if (ret < 0)
+            break;
+    }
+    if (ret < 0) {
+        printf("connection_pool=%d: failed: %s\n", pool, av_err2str(ret));
+        return 1;
+    }
+
+    printf("connection_pool=%d: %d requests, %d connections\n",
+           pool, srv->nb_requests, srv->nb_connections);
+    return 0;
+}
+
+int main(void)
+{
+    struct sockaddr_in addr = { 0 };
+    socklen_t addr_len = sizeof(addr);
+    Server srv = { 0 };
+    int ret;
+
+    if (avformat_network_init() < 0)
+        return 1;
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        srv.fds[i] = -1;
+
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    srv.listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv.listen_fd < 0 ||
+        bind(srv.listen_fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+        listen(srv.listen_fd, MAX_CLIENTS) ||
+        getsockname(srv.listen_fd, (struct sockaddr *)&addr, &addr_len)) {
+        printf("could not set up the server\n");
+        return 1;
+    }
+
+    ret  = run(&srv, ntohs(addr.sin_port), 0);
+    ret |= run(&srv, ntohs(addr.sin_port), 1);
+
+    for (int i = 0; i < MAX_CLIENTS; i++)
+        if (srv.fds[i] >= 0)
+            closesocket(srv.fds[i]);
+    closesocket(srv.listen_fd);
+    avformat_network_deinit();
+
+    return ret;
+}
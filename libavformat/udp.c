@@ -26,6 +26,7 @@
 
 #define _DEFAULT_SOURCE
 #define _BSD_SOURCE     /* Needed for using struct ip_mreq with recent glibc */
+#define _GNU_SOURCE     /* Needed for recvmmsg() with glibc */
 
 #include "avformat.h"
 #include "avio_internal.h"
@@ -102,6 +103,7 @@ typedef struct UDPContext {
     int circular_buffer_error;
     int64_t bitrate; /* number of bits to send per second */
     int64_t burst_bits;
+    int busy_wait;
     int close_req;
 #if HAVE_PTHREAD_CANCEL
     pthread_t circular_buffer_thread;
@@ -110,6 +112,14 @@ typedef struct UDPContext {
     int thread_started;
 #endif
     uint8_t tmp[UDP_MAX_PKT_SIZE+4];
+#if HAVE_RECVMMSG
+    /* receive buffers of the circular buffer thread, when batching */
+    struct mmsghdr *rx_msgs;
+    struct iovec *rx_iov;
+    struct sockaddr_storage *rx_addrs;
+    uint8_t *rx_buf;
+#endif
+    int recv_batch;
     int remaining_in_dg;
     char *localaddr;
     int timeout;
@@ -126,6 +136,7 @@ static const AVOption options[] = {
     { "buffer_size",    "System data size (in bytes)",                     OFFSET(buffer_size),    AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, INT_MAX, .flags = D|E },
     { "bitrate",        "Bits to send per second",                         OFFSET(bitrate),        AV_OPT_TYPE_INT64,  { .i64 = 0  },     0, INT64_MAX, .flags = E },
     { "burst_bits",     "Max length of bursts in bits (when using bitrate)", OFFSET(burst_bits),   AV_OPT_TYPE_INT64,  { .i64 = 0  },     0, INT64_MAX, .flags = E },
+    { "busy_wait",      "Time in microseconds to busy-wait instead of sleeping before sending a packet (when using bitrate)", OFFSET(busy_wait), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, 1000000, .flags = E },
     { "localport",      "Local port",                                      OFFSET(local_port),     AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, INT_MAX, D|E },
     { "local_port",     "Local port",                                      OFFSET(local_port),     AV_OPT_TYPE_INT,    { .i64 = -1 },    -1, INT_MAX, .flags = D|E },
     { "localaddr",      "Local address",                                   OFFSET(localaddr),      AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
@@ -138,6 +149,7 @@ static const AVOption options[] = {
     { "connect",        "set if connect() should be called on socket",     OFFSET(is_connected),   AV_OPT_TYPE_BOOL,   { .i64 =  0 },     0, 1,       .flags = D|E },
     { "fifo_size",      "set the UDP receiving circular buffer size, expressed as a number of packets with size of 188 bytes", OFFSET(circular_buffer_size), AV_OPT_TYPE_INT, {.i64 = 7*4096}, 0, INT_MAX, D },
     { "overrun_nonfatal", "survive in case of UDP receiving circular buffer overrun", OFFSET(overrun_nonfatal), AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1,    D },
+    { "recv_batch",     "set the number of datagrams read per system call by the receiving thread", OFFSET(recv_batch), AV_OPT_TYPE_INT, {.i64 = 1}, 1, 1024, D },
     { "timeout",        "set raise error timeout, in microseconds (only in read mode)",OFFSET(timeout),         AV_OPT_TYPE_INT,  {.i64 = 0}, 0, INT_MAX, D },
     { "sources",        "Source list",                                     OFFSET(sources),        AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
     { "block",          "Block list",                                      OFFSET(block),          AV_OPT_TYPE_STRING, { .str = NULL },               .flags = D|E },
@@ -481,6 +493,69 @@ static int udp_get_file_handle(URLContext *h)
 }
 
 #if HAVE_PTHREAD_CANCEL
+/**
+ * Write a received datagram to the circular buffer, the mutex being locked.
+ * @param buf  4 bytes of room for the datagram size, followed by the datagram
+ * @return 0 on success or if the datagram was dropped, a negative error code
+ *         if the thread must stop
+ */
+static int circular_buffer_write(URLContext *h, uint8_t *buf, int len,
+                                 struct sockaddr_storage *addr)
+{
+    UDPContext *s = h->priv_data;
+
+    if (ff_ip_check_source_lists(addr, &s->filters))
+        return 0;
+    AV_WL32(buf, len);
+
+    if (av_fifo_can_write(s->fifo) < len + 4) {
+        /* No Space left */
+        if (s->overrun_nonfatal) {
+            av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
+                    "Surviving due to overrun_nonfatal option\n");
+            return 0;
+        } else {
+            av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
+                    "To avoid, increase fifo_size URL option. "
+                    "To survive in such case, use overrun_nonfatal option\n");
+            s->circular_buffer_error = AVERROR(EIO);
+            return s->circular_buffer_error;
+        }
+    }
+    av_fifo_write(s->fifo, buf, len + 4);
+    pthread_cond_signal(&s->cond);
+    return 0;
+}
+
+#if HAVE_RECVMMSG
+static int alloc_recv_batch(UDPContext *s)
+{
+    s->rx_msgs  = av_calloc(s->recv_batch, sizeof(*s->rx_msgs));
+    s->rx_iov   = av_calloc(s->recv_batch, sizeof(*s->rx_iov));
+    s->rx_addrs = av_calloc(s->recv_batch, sizeof(*s->rx_addrs));
+    s->rx_buf   = av_malloc_array(s->recv_batch, UDP_MAX_PKT_SIZE + 4);
+    if (!s->rx_msgs || !s->rx_iov || !s->rx_addrs || !s->rx_buf)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < s->recv_batch; i++) {
+        s->rx_iov[i].iov_base = s->rx_buf + i * (UDP_MAX_PKT_SIZE + 4) + 4;
+        s->rx_iov[i].iov_len  = UDP_MAX_PKT_SIZE;
+        s->rx_msgs[i].msg_hdr.msg_iov    = &s->rx_iov[i];
+        s->rx_msgs[i].msg_hdr.msg_iovlen = 1;
+        s->rx_msgs[i].msg_hdr.msg_name   = &s->rx_addrs[i];
+    }
+    return 0;
+}
+
+static void free_recv_batch(UDPContext *s)
+{
+    av_freep(&s->rx_msgs);
+    av_freep(&s->rx_iov);
+    av_freep(&s->rx_addrs);
+    av_freep(&s->rx_buf);
+}
+#endif
+
 static void *circular_buffer_task_rx( void *_URLContext)
 {
     URLContext *h = _URLContext;
@@ -504,6 +579,14 @@ static void *circular_buffer_task_rx( void *_URLContext)
            see "General Information" / "Thread Cancelation Overview"
            in Single Unix. */
         pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old_cancelstate);
+#if HAVE_RECVMMSG
+        if (s->rx_msgs) {
+            for (int i = 0; i < s->recv_batch; i++)
+                s->rx_msgs[i].msg_hdr.msg_namelen = sizeof(*s->rx_addrs);
+            /* wait for the first datagram only, then take what is queued */
+            len = recvmmsg(s->udp_fd, s->rx_msgs, s->recv_batch, MSG_WAITFORONE, NULL);
+        } else
+#endif
         len = recvfrom(s->udp_fd, s->tmp+4, sizeof(s->tmp)-4, 0, (struct sockaddr *)&addr, &addr_len);
         pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_cancelstate);
         pthread_mutex_lock(&s->mutex);
@@ -514,26 +597,18 @@ static void *circular_buffer_task_rx( void *_URLContext)
             }
             continue;
         }
-        if (ff_ip_check_source_lists(&addr, &s->filters))
-            continue;
-        AV_WL32(s->tmp, len);
-
-        if (av_fifo_can_write(s->fifo) < len + 4) {
-            /* No Space left */
-            if (s->overrun_nonfatal) {
-                av_log(h, AV_LOG_WARNING, "Circular buffer overrun. "
-                        "Surviving due to overrun_nonfatal option\n");
-                continue;
-            } else {
-                av_log(h, AV_LOG_ERROR, "Circular buffer overrun. "
-                        "To avoid, increase fifo_size URL option. "
-                        "To survive in such case, use overrun_nonfatal option\n");
-                s->circular_buffer_error = AVERROR(EIO);
-                goto end;
+#if HAVE_RECVMMSG
+        if (s->rx_msgs) {
+            for (int i = 0; i < len; i++) {
+                uint8_t *buf = (uint8_t *)s->rx_iov[i].iov_base - 4;
+                if (circular_buffer_write(h, buf, s->rx_msgs[i].msg_len, &s->rx_addrs[i]) < 0)
+                    goto end;
             }
+            continue;
         }
-        av_fifo_write(s->fifo, s->tmp, len + 4);
-        pthread_cond_signal(&s->cond);
+#endif
+        if (circular_buffer_write(h, s->tmp, len, &addr) < 0)
+            goto end;
     }
 
 end:
@@ -542,6 +617,22 @@ end:
     return NULL;
 }
 
+/**
+ * Wait until the given time, sleeping first and busy-waiting for the last
+ * busy_wait microseconds, as sleeps are only accurate to the scheduler
+ * granularity.
+ */
+static void udp_wait_until(UDPContext *s, int64_t deadline)
+{
+    int64_t delay = deadline - av_gettime_relative();
+
+    if (delay > s->busy_wait)
+        av_usleep(delay - s->busy_wait);
+    if (s->busy_wait)
+        while (av_gettime_relative() < deadline)
+            ;
+}
+
 static void *circular_buffer_task_tx( void *_URLContext)
 {
     URLContext *h = _URLContext;
@@ -551,6 +642,9 @@ static void *circular_buffer_task_tx( void *_URLContext)
     int64_t sent_bits = 0;
     int64_t burst_interval = s->bitrate ? (s->burst_bits * 1000000 / s->bitrate) : 0;
     int64_t max_delay = s->bitrate ?  ((int64_t)h->max_packet_size * 8 * 1000000 / s->bitrate + 1) : 0;
+    /* send time deviation statistics, over one second */
+    int64_t stats_start = start_timestamp, jitter_sum = 0, jitter_max = 0;
+    int nb_paced = 0;
 
     pthread_mutex_lock(&s->mutex);
 
@@ -564,7 +658,8 @@ static void *circular_buffer_task_tx( void *_URLContext)
         int len;
         const uint8_t *p;
         uint8_t tmp[4];
-        int64_t timestamp;
+        int64_t timestamp, late;
+        int idle = 0;
 
         len = av_fifo_can_read(s->fifo);
 
@@ -573,6 +668,7 @@ static void *circular_buffer_task_tx( void *_URLContext)
                 goto end;
             pthread_cond_wait(&s->cond, &s->mutex);
             len = av_fifo_can_read(s->fifo);
+            idle = 1;
         }
 
         av_fifo_read(s->fifo, tmp, 4);
@@ -594,15 +690,35 @@ static void *circular_buffer_task_tx( void *_URLContext)
                     start_timestamp = timestamp + delay;
                     sent_bits = 0;
                 }
-                av_usleep(delay);
+                udp_wait_until(s, timestamp + delay);
+
+                late = av_gettime_relative() - (timestamp + delay);
             } else {
+                /* Behind schedule, sent without waiting. This is only late
+                 * if the packet was already queued, not after an idle
+                 * period without packets. */
+                late = idle ? 0 : timestamp - target_timestamp;
                 if (timestamp - burst_interval > target_timestamp) {
                     start_timestamp = timestamp - burst_interval;
                     sent_bits = 0;
                 }
             }
+            jitter_sum += late;
+            jitter_max  = FFMAX(jitter_max, late);
+            nb_paced++;
             sent_bits += len * 8;
             target_timestamp = start_timestamp + sent_bits * 1000000 / s->bitrate;
+
+            timestamp = av_gettime_relative();
+            if (timestamp - stats_start >= 1000000) {
+                if (nb_paced)
+                    av_log(h, AV_LOG_VERBOSE, "Paced %d packets, send time "
+                           "deviation: mean %"PRId64" us, max %"PRId64" us\n",
+                           nb_paced, jitter_sum / nb_paced, jitter_max);
+                stats_start = timestamp;
+                jitter_sum  = jitter_max = 0;
+                nb_paced    = 0;
+            }
         }
 
         p = s->tmp;
@@ -730,9 +846,19 @@ static int udp_open(URLContext *h, const char *uri, int flags)
                        "'bitrate' option was set but it is not supported "
                        "on this build (pthread support is required)\n");
         }
+        if (av_find_info_tag(buf, sizeof(buf), "recv_batch", p)) {
+            s->recv_batch = strtol(buf, NULL, 10);
+            if (s->recv_batch < 1 || s->recv_batch > 1024) {
+                ret = AVERROR(EINVAL);
+                goto fail;
+            }
+        }
         if (av_find_info_tag(buf, sizeof(buf), "burst_bits", p)) {
             s->burst_bits = strtoll(buf, NULL, 10);
         }
+        if (av_find_info_tag(buf, sizeof(buf), "busy_wait", p)) {
+            s->busy_wait = av_clip(strtol(buf, NULL, 10), 0, 1000000);
+        }
         if (av_find_info_tag(buf, sizeof(buf), "localaddr", p)) {
             av_freep(&s->localaddr);
             s->localaddr = av_strdup(buf);
@@ -934,6 +1060,11 @@ static int udp_open(URLContext *h, const char *uri, int flags)
             ret = AVERROR(ENOMEM);
             goto fail;
         }
+#if HAVE_RECVMMSG
+        if (!is_output && s->recv_batch > 1 &&
+            (ret = alloc_recv_batch(s)) < 0)
+            goto fail;
+#endif
         ret = pthread_mutex_init(&s->mutex, NULL);
         if (ret != 0) {
             av_log(h, AV_LOG_ERROR, "pthread_mutex_init failed : %s\n", strerror(ret));
@@ -967,6 +1098,9 @@ static int udp_open(URLContext *h, const char *uri, int flags)
     if (udp_fd >= 0)
         closesocket(udp_fd);
     av_fifo_freep2(&s->fifo);
+#if HAVE_PTHREAD_CANCEL && HAVE_RECVMMSG
+    free_recv_batch(s);
+#endif
     ff_ip_reset_filters(&s->filters);
     return ret;
 }
@@ -1136,6 +1270,9 @@ static int udp_close(URLContext *h)
 #endif
     closesocket(s->udp_fd);
     av_fifo_freep2(&s->fifo);
+#if HAVE_PTHREAD_CANCEL && HAVE_RECVMMSG
+    free_recv_batch(s);
+#endif
     ff_ip_reset_filters(&s->filters);
     return 0;
 }
@@ -561,6 +561,26 @@ concat(){
     fi
 }
 
+chunked_transcode(){
+    srcfile="${outdir}/${test}-in.nut"
+    encfile="${outdir}/${test}.nut"
+    test $keep -ge 1 || cleanfiles="$cleanfiles $srcfile $encfile"
+    ffmpeg -f lavfi -i "testsrc2=d=4:s=160x120:r=30000/1001" $1 -f nut -y $(target_path $srcfile) || return
+    $target_exec python3 ${base}/../tools/chunked_transcode.py -j 2 -n 4 \
+        --ffmpeg $(target_path ffmpeg${PROGSUF}${EXECSUF}) \
+        --ffprobe $(target_path ffprobe${PROGSUF}${EXECSUF}) \
+        $(target_path $srcfile) $1 -threads 1 -flags +bitexact -fflags +bitexact \
+        $(target_path $encfile) >/dev/null || return
+    framecrc -i $(target_path $encfile) -c copy
+}
+
+seek_index(){
+    indexfile="${outdir}/${test}.idx"
+    cleanfiles="$indexfile"
+    run tools/seekindex${EXESUF} "$1" $indexfile || return
+    run libavformat/tests/seek${EXESUF} "$1" -seek_index $indexfile
+}
+
 venc_data(){
     file=$1
     stream=$2
@@ -23,5 +23,22 @@ $(foreach D,$(FATE_CONCAT_DEMUXER_EXTENDED_LAVF),$(eval fate-concat-demuxer-exte
 $(foreach D,$(FATE_CONCAT_DEMUXER_EXTENDED_LAVF),$(eval fate-concat-demuxer-extended-lavf-$(D): CMD = concat $(SRC_PATH)/tests/extended.ffconcat ../lavf/lavf.$(D) md5))
 FATE_CONCAT_DEMUXER += $(FATE_CONCAT_DEMUXER_EXTENDED_LAVF:%=fate-concat-demuxer-extended-lavf-%)
 
+# The preopen and homogeneous options must not change the demuxed packets,
+# so these tests share the references of the tests above.
+define FATE_CONCAT_DEMUXER_OPT
+fate-concat-demuxer-$(1)-$(2)-lavf-$(3): fate-lavf-$(3)
+fate-concat-demuxer-$(1)-$(2)-lavf-$(3): CMD = concat $(SRC_PATH)/tests/$(1).ffconcat ../lavf/lavf.$(3) "" "-$(2) 1"
+fate-concat-demuxer-$(1)-$(2)-lavf-$(3): REF = $(SRC_PATH)/tests/ref/fate/concat-demuxer-$(1)-lavf-$(3)
+FATE_CONCAT_DEMUXER += fate-concat-demuxer-$(1)-$(2)-lavf-$(3)
+endef
+
+$(foreach O,preopen homogeneous,$(foreach D,$(FATE_CONCAT_DEMUXER_SIMPLE1_LAVF),$(eval $(call FATE_CONCAT_DEMUXER_OPT,simple1,$(O),$(D)))))
+$(foreach O,preopen homogeneous,$(foreach D,$(FATE_CONCAT_DEMUXER_SIMPLE2_LAVF),$(eval $(call FATE_CONCAT_DEMUXER_OPT,simple2,$(O),$(D)))))
+
 FATE_CONCAT_DEMUXER := $(if $(CONFIG_CONCAT_DEMUXER), $(FATE_CONCAT_DEMUXER))
 FATE_FFPROBE += $(FATE_CONCAT_DEMUXER)
+
+# tools/chunked_transcode.py needs a Python 3 interpreter on the host.
+FATE_CHUNKED_TRANSCODE-$(call ALLYES, CONCAT_DEMUXER NUT_MUXER NUT_DEMUXER MPEG4_ENCODER MPEG4_DECODER LAVFI_INDEV TESTSRC2_FILTER) += fate-chunked-transcode
+fate-chunked-transcode: CMD = chunked_transcode "-c:v mpeg4 -g 10 -qscale:v 4"
+FATE_FFMPEG_FFPROBE += $(if $(shell command -v python3),$(FATE_CHUNKED_TRANSCODE-yes))
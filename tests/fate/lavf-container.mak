@@ -4,8 +4,9 @@ FATE_LAVF_CONTAINER-$(call ENCDEC2, DVVIDEO,    PCM_S16LE, AVI)                +
 FATE_LAVF_CONTAINER-$(call ENCDEC,  FLV,                   FLV)                += flv
 FATE_LAVF_CONTAINER-$(call ENCDEC,  RAWVIDEO,              FILMSTRIP)          += flm
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, PCM_S16LE, GXF)                += gxf gxf_pal gxf_ntsc
-FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      MP2,       MATROSKA)           += mkv mkv_attachment
-FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      PCM_ALAW,  MOV)                += mov mov_rtphint ismv
+FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      MP2,       MATROSKA)           += mkv mkv_attachment mkv_live_cues
+FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      PCM_ALAW,  MOV)                += mov mov_rtphint ismv \
+                                                                                   mov_moov_fits mov_moov_overflow
 FATE_LAVF_CONTAINER-$(call ENCDEC,  MPEG4,                 MOV)                += mp4
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG1VIDEO, MP2,       MPEG1SYSTEM MPEGPS) += mpg
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, PCM_S16LE, MXF)                += mxf mxf_dv25 mxf_dvcpro50
@@ -15,11 +16,12 @@ FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG4,      MP2,       NUT)                +
 FATE_LAVF_CONTAINER-$(call ENCMUX,  RV10 AC3_FIXED,        RM)                 += rm
 FATE_LAVF_CONTAINER-$(call ENCDEC2, MJPEG,      PCM_S16LE, SMJPEG)             += smjpeg
 FATE_LAVF_CONTAINER-$(call ENCDEC,  FLV,                   SWF)                += swf
-FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, MP2,       MPEGTS)             += ts
+FATE_LAVF_CONTAINER-$(call ENCDEC2, MPEG2VIDEO, MP2,       MPEGTS)             += ts m2ts
 FATE_LAVF_CONTAINER-$(call ENCDEC,  MP2,                   WTV)                += wtv
 
 FATE_LAVF_CONTAINER_RESAMPLE := asf avi dv_pal dv_ntsc gxf_pal gxf_ntsc  \
-                                mkv mkv_attachment mpg mxf nut rm ts wtv
+                                mkv mkv_attachment mkv_live_cues mpg mxf \
+                                nut rm ts m2ts wtv
 FATE_LAVF_CONTAINER-$(!CONFIG_ARESAMPLE_FILTER) := $(filter-out $(FATE_LAVF_CONTAINER_RESAMPLE),$(FATE_LAVF_CONTAINER-yes))
 
 FATE_LAVF_CONTAINER_SCALE := dv dv_pal dv_ntsc flm gxf gxf_pal gxf_ntsc \
@@ -47,7 +49,12 @@ fate-lavf-gxf_ntsc: CMD = lavf_container_timecode_drop "-ar 48000 -s ntsc -ac 1
 fate-lavf-ismv: CMD = lavf_container_timecode "-an -write_tmcd 1 -c:v mpeg4 -threads 1"
 fate-lavf-mkv: CMD = lavf_container "" "-c:a mp2 -c:v mpeg4 -ar 44100 -threads 1"
 fate-lavf-mkv_attachment: CMD = lavf_container_attach "-c:a mp2 -c:v mpeg4 -threads 1 -f matroska"
+fate-lavf-mkv_live_cues: CMD = lavf_container "" "-c:a mp2 -c:v mpeg4 -ar 44100 -threads 1 -f matroska -live 1 -live_cues 1"
 fate-lavf-mov: CMD = lavf_container_timecode "-movflags +faststart -c:a pcm_alaw -c:v mpeg4 -threads 1"
+# The moov atom is written in the reserved space when it fits, or the
+# file is shifted as with plain faststart when it does not.
+fate-lavf-mov_moov_fits: CMD = lavf_container "" "-movflags +faststart -moov_size_estimate 1 -c:a pcm_alaw -c:v mpeg4 -threads 1 -f mov"
+fate-lavf-mov_moov_overflow: CMD = lavf_container "" "-movflags +faststart -moov_size 16 -c:a pcm_alaw -c:v mpeg4 -threads 1 -f mov"
 fate-lavf-mov_rtphint: CMD = lavf_container "" "-movflags +rtphint -c:a pcm_alaw -c:v mpeg4 -threads 1 -f mov"
 fate-lavf-mp4: CMD = lavf_container_timecode "-c:v mpeg4 -an -threads 1"
 fate-lavf-mpg: CMD = lavf_container_timecode "-ar 44100 -threads 1"
@@ -60,7 +67,7 @@ fate-lavf-mxf_opatom_audio: CMD = lavf_container "-ar 48000 -ac 1" "-f mxf_opato
 fate-lavf-smjpeg:  CMD = lavf_container "" "-f smjpeg"
 # The RealMedia muxer is broken.
 fate-lavf-rm:  CMD = lavf_container "" "-c:a ac3_fixed" disable_crc
-fate-lavf-ts:  CMD = lavf_container "" "-mpegts_transport_stream_id 42 -ar 44100 -threads 1"
+fate-lavf-ts fate-lavf-m2ts:  CMD = lavf_container "" "-mpegts_transport_stream_id 42 -ar 44100 -threads 1"
 fate-lavf-wtv: CMD = lavf_container "" "-c:a mp2 -threads 1"
 
 FATE_AVCONV += $(FATE_LAVF_CONTAINER)
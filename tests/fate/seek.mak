@@ -136,7 +136,7 @@ FATE_SEEK += $(FATE_SEEK_LAVF_AUDIO)
 
 # files from fate-lavf-container
 
-FATE_SEEK_LAVF_CONTAINER += asf avi dv flv gxf mkv mov mpg    \
+FATE_SEEK_LAVF_CONTAINER += asf avi dv flv gxf mkv mkv_live_cues mov mpg \
                             mxf mxf_d10 mxf_dv25 mxf_dvcpro50 \
                             mxf_opatom mxf_opatom_audio       \
                             nut swf ts wtv
@@ -198,6 +198,13 @@ fate-seek-mkv-codec-delay:   CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_
 
 FATE_SEEK_EXTRA += $(FATE_SEEK_EXTRA-yes)
 
+# seek through an index written by tools/seekindex
+FATE_SEEK_INDEX := $(filter fate-seek-lavf-ts,$(FATE_SEEK_LAVF_CONTAINER))
+FATE_SEEK_INDEX := $(FATE_SEEK_INDEX:fate-seek-lavf-%=fate-seek-index-lavf-%)
+$(FATE_SEEK_INDEX): libavformat/tests/seek$(EXESUF) tools/seekindex$(EXESUF)
+$(FATE_SEEK_INDEX): fate-seek-index-%: fate-%
+$(FATE_SEEK_INDEX): CMD = seek_index $(TARGET_PATH)/tests/data/lavf/lavf.$(@:fate-seek-index-lavf-%=%)
+
 
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA): libavformat/tests/seek$(EXESUF)
 $(FATE_SEEK) $(FATE_SAMPLES_SEEK): CMD = run libavformat/tests/seek$(EXESUF) $(TARGET_PATH)/tests/data/$(SRC)
@@ -205,6 +212,6 @@ $(FATE_SEEK) $(FATE_SAMPLES_SEEK): fate-seek-%: fate-%
 $(subst fate-seek-,fate-,$(FATE_SAMPLES_SEEK) $(FATE_SEEK)): KEEP_FILES ?= 1
 fate-seek-%: REF = $(SRC_PATH)/tests/ref/seek/$(@:fate-seek-%=%)
 
-FATE_AVCONV += $(FATE_SEEK)
+FATE_AVCONV += $(FATE_SEEK) $(FATE_SEEK_INDEX)
 FATE_SAMPLES_AVCONV += $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
-fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA)
+fate-seek:     $(FATE_SEEK) $(FATE_SAMPLES_SEEK) $(FATE_SEEK_EXTRA) $(FATE_SEEK_INDEX)
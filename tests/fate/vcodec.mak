@@ -156,11 +156,15 @@ $(FATE_VCODEC_DV:%=fate-vsynth\%-%): DECOPTS += $(DEFAULT_SIZE)
 
 FATE_VCODEC-$(call ENCDEC, FFV1, AVI)   += ffv1 ffv1-v0 \
                                            ffv1-v3-yuv420p \
-                                           ffv1-2pass
+                                           ffv1-2pass ffv1-slice-threads \
+                                           ffv1-intra ffv1-frame-threads
 FATE_VCODEC_SCALE-$(call ENCDEC, FFV1, AVI) += ffv1-v3-yuv422p10 ffv1-v3-yuv444p16 \
                                                ffv1-v3-bgr0 ffv1-v3-rgb48
 fate-vsynth%-ffv1:               ENCOPTS = -slices 4
 fate-vsynth%-ffv1-v0:            CODEC   = ffv1
+fate-vsynth%-ffv1-slice-threads: ENCOPTS = -slices 4 -threads 2
+fate-vsynth%-ffv1-intra:         ENCOPTS = -slices 4 -g 1
+fate-vsynth%-ffv1-frame-threads: ENCOPTS = -slices 4 -g 1 -threads 2 -thread_type frame
 fate-vsynth%-ffv1-v3-yuv420p:    ENCOPTS = -level 3 -pix_fmt yuv420p
 fate-vsynth%-ffv1-v3-yuv422p10:  ENCOPTS = -level 3 -pix_fmt yuv422p10 \
                                            -sws_flags neighbor+bitexact
@@ -458,7 +462,9 @@ FATE_VCODEC += $(FATE_VCODEC-yes)
 FATE_VCODEC := $(if $(call ENCDEC, RAWVIDEO, RAWVIDEO),$(FATE_VCODEC))
 FATE_VSYNTH1 = $(FATE_VCODEC:%=fate-vsynth1-%)
 FATE_VSYNTH2 = $(FATE_VCODEC:%=fate-vsynth2-%)
-FATE_VSYNTH_LENA = $(FATE_VCODEC:%=fate-vsynth_lena-%)
+# No references yet, they need the lena sample to be generated
+LENA_OFF     = ffv1-intra ffv1-frame-threads
+FATE_VSYNTH_LENA = $(filter-out $(LENA_OFF:%=fate-vsynth_lena-%),$(FATE_VCODEC:%=fate-vsynth_lena-%))
 # Redundant tests because they just resize the input
 RESIZE_OFF   = dnxhd-720p dnxhd-720p-rd dnxhd-720p-10bit dnxhd-1080i \
                dv dv-411 dv-50 avui snow snow-hpel snow-ll vc2-420p \
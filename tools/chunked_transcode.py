@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+#
+# Transcode the video of a file in independent chunks on several parallel
+# ffmpeg processes, then concatenate them with the concat demuxer.
+#
+# The chunk boundaries are placed on keyframes of the input, so every chunk
+# can be decoded on its own and the encoders start each chunk with a closed
+# GOP. Audio and subtitles are taken from the input in the final stitching
+# pass, which avoids encoder priming gaps at the chunk boundaries.
+#
+# usage: chunked_transcode.py [-j jobs] [-n chunks] [-a audio_options]
+#                             <input> [video_encode_options] <output>
+#
+# e.g.   chunked_transcode.py -j 8 -a "-c:a aac -b:a 128k" in.mkv \
+#            -c:v libx264 -preset slow -crf 20 out.mp4
+
+import argparse, os, shlex, shutil, subprocess, sys, tempfile
+from concurrent.futures import ThreadPoolExecutor
+
+# Seek and trim slightly before the keyframe timestamps, as ffprobe prints
+# them rounded to microseconds.
+EPSILON = 0.0005
+
+def probe(ffprobe, ifile, entries, *opts):
+    cmd = [ffprobe, '-v', 'error', '-of', 'csv=p=0', *opts,
+           '-show_entries', entries, ifile]
+    return subprocess.check_output(cmd, universal_newlines=True).splitlines()
+
+def keyframe_times(ffprobe, ifile):
+    times = []
+    for line in probe(ffprobe, ifile, 'packet=pts_time,flags',
+                      '-select_streams', 'v:0'):
+        fields = line.split(',')
+        if len(fields) >= 2 and 'K' in fields[1] and fields[0] != 'N/A':
+            times.append(float(fields[0]))
+    return sorted(times)
+
+def chunk_bounds(keyframes, duration, nb_chunks):
+    start = keyframes[0]
+    bounds = [start]
+    for i in range(1, nb_chunks):
+        target = start + (duration - start) * i / nb_chunks
+        cut = next((t for t in keyframes if t >= target), None)
+        if cut is not None and cut > bounds[-1]:
+            bounds.append(cut)
+    return bounds
+
+def main():
+    parser = argparse.ArgumentParser(usage='%(prog)s [-j jobs] [-n chunks] '
+                                     '[-a audio_options] <input> '
+                                     '[video_encode_options] <output>')
+    parser.add_argument('-j', type=int, default=os.cpu_count(),
+                        help='number of parallel encoders')
+    parser.add_argument('-n', type=int, default=0,
+                        help='number of chunks, 4 per job by default')
+    parser.add_argument('-a', default='-c:a copy',
+                        help='options for the audio in the final pass')
+    parser.add_argument('--ffmpeg', default='ffmpeg')
+    parser.add_argument('--ffprobe', default='ffprobe')
+    parser.add_argument('--keep', action='store_true',
+                        help='keep the temporary chunk files')
+    args, rest = parser.parse_known_args()
+    if len(rest) < 2:
+        parser.print_usage()
+        sys.exit(1)
+    ifile, encopt, ofile = rest[0], rest[1:-1], rest[-1]
+
+    # ffmpeg's -ss and -to are relative to the start time of the input
+    start, duration = map(float, probe(args.ffprobe, ifile,
+                                       'format=start_time,duration')[0].split(','))
+    keyframes = [t - start for t in keyframe_times(args.ffprobe, ifile)]
+    if not keyframes:
+        sys.exit('No video keyframes found in ' + ifile)
+
+    bounds = chunk_bounds(keyframes, duration, args.n or 4 * args.j)
+    tmpdir = tempfile.mkdtemp(prefix='chunks', dir=os.path.dirname(os.path.abspath(ofile)))
+    chunks = [os.path.join(tmpdir, 'chunk%05d.nut' % i) for i in range(len(bounds))]
+
+    def encode(i):
+        cmd = [args.ffmpeg, '-nostdin', '-v', 'error', '-y',
+               '-ss', '%f' % max(bounds[i] - EPSILON, 0)]
+        if i + 1 < len(bounds):
+            cmd += ['-to', '%f' % (bounds[i + 1] - EPSILON)]
+        cmd += ['-i', ifile, '-map', '0:v:0', '-an', '-sn', '-dn',
+                *encopt, '-f', 'nut', chunks[i]]
+        return subprocess.call(cmd)
+
+    try:
+        print('Encoding %d chunks on %d jobs' % (len(chunks), args.j))
+        with ThreadPoolExecutor(max_workers=args.j) as pool:
+            results = list(pool.map(encode, range(len(chunks))))
+        if any(results):
+            sys.exit('Encoding chunk %d failed' % next(i for i, r in enumerate(results) if r))
+
+        concat = os.path.join(tmpdir, 'chunks.ffconcat')
+        with open(concat, 'w') as f:
+            f.write('ffconcat version 1.0\n')
+            for i, c in enumerate(chunks):
+                f.write("file '%s'\n" % os.path.basename(c))
+                # Place every chunk at its keyframe rather than after the
+                # estimated end of the previous one.
+                if i + 1 < len(chunks):
+                    f.write('duration %f\n' % (bounds[i + 1] - bounds[i]))
+
+        cmd = [args.ffmpeg, '-nostdin', '-v', 'error', '-y',
+               '-itsoffset', '%f' % bounds[0], '-f', 'concat', '-i', concat, '-i', ifile,
+               '-map', '0:v', '-map', '1:a?', '-map', '1:s?', '-c:v', 'copy',
+               *shlex.split(args.a), ofile]
+        ret = subprocess.call(cmd)
+    finally:
+        if not args.keep:
+            shutil.rmtree(tmpdir)
+    sys.exit(ret)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,120 @@
+/*
+ * Generate a seek index sidecar file
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Scans a file once and writes the position and dts of its keyframes in the
+ * format read by the seek_index option of the mpegts and aac demuxers:
+ *
+ * seekindex [-i interval] input output
+ *
+ * With -i, at most one entry per stream is written every interval seconds.
+ */
+
+#include <inttypes.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavformat/avformat.h"
+#include "libavutil/mathematics.h"
+#include "libavutil/mem.h"
+
+static int usage(const char *argv0, int ret)
+{
+    fprintf(stderr, "%s [-i interval] input output\n", argv0);
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    AVFormatContext *ifmt = NULL;
+    AVPacket *pkt = NULL;
+    FILE *out = NULL;
+    int64_t *last_dts = NULL;
+    double interval = 0;
+    int i, ret;
+
+    for (i = 1; i < argc - 2; i++) {
+        if (!strcmp(argv[i], "-i") && i + 1 < argc - 2) {
+            interval = atof(argv[++i]);
+        } else {
+            return usage(argv[0], 1);
+        }
+    }
+    if (argc - i != 2)
+        return usage(argv[0], 1);
+
+    if ((ret = avformat_open_input(&ifmt, argv[i], NULL, NULL)) < 0) {
+        fprintf(stderr, "Unable to open %s: %s\n", argv[i], av_err2str(ret));
+        return 1;
+    }
+    if ((ret = avformat_find_stream_info(ifmt, NULL)) < 0) {
+        fprintf(stderr, "Unable to find stream info: %s\n", av_err2str(ret));
+        goto fail;
+    }
+
+    pkt      = av_packet_alloc();
+    last_dts = av_malloc_array(ifmt->nb_streams, sizeof(*last_dts));
+    if (!pkt || !last_dts) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    for (unsigned j = 0; j < ifmt->nb_streams; j++)
+        last_dts[j] = AV_NOPTS_VALUE;
+
+    out = fopen(argv[i + 1], "w");
+    if (!out) {
+        fprintf(stderr, "Unable to open %s\n", argv[i + 1]);
+        ret = AVERROR(errno);
+        goto fail;
+    }
+    fprintf(out, "ffseekindex 1\n");
+
+    while ((ret = av_read_frame(ifmt, pkt)) >= 0) {
+        const AVStream *st = ifmt->streams[pkt->stream_index];
+        int64_t *last = &last_dts[pkt->stream_index];
+
+        if ((pkt->flags & AV_PKT_FLAG_KEY) && pkt->pos >= 0 &&
+            pkt->dts != AV_NOPTS_VALUE &&
+            (*last == AV_NOPTS_VALUE || pkt->dts > *last) &&
+            (*last == AV_NOPTS_VALUE ||
+             (pkt->dts - *last) * av_q2d(st->time_base) >= interval)) {
+            fprintf(out, "%d %"PRId64" %"PRId64"\n",
+                    pkt->stream_index, pkt->dts, pkt->pos);
+            *last = pkt->dts;
+        }
+        av_packet_unref(pkt);
+    }
+    if (ret == AVERROR_EOF)
+        ret = 0;
+
+fail:
+    if (out && fclose(out) && !ret)
+        ret = AVERROR(errno);
+    av_free(last_dts);
+    av_packet_free(&pkt);
+    avformat_close_input(&ifmt);
+    if (ret < 0) {
+        fprintf(stderr, "Error: %s\n", av_err2str(ret));
+        return 1;
+    }
+    return 0;
+}